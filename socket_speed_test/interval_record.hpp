@@ -0,0 +1,79 @@
+#ifndef _INTERVAL_RECORD_HPP_
+#define _INTERVAL_RECORD_HPP_
+
+#include <string>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "util/histogram.h"
+
+// one report interval of one link (ids are 1 based, link 0 is the sum of all links)
+struct interval_record_t
+{
+	long long time_ms{ 0 }; // unix time at the end of the interval
+	long long elapsed_ms{ 0 }; // since the start of the run
+	long long interval_ms{ 0 };
+	const char * role{ "" }; // tx, rx, ping-pong
+	const char * direction{ "" }; // tx or rx, a full duplex link has a record for each
+	std::size_t link_id{ 0 };
+	std::size_t server_id{ 0 };
+	std::size_t client_id{ 0 };
+	std::size_t port_id{ 0 };
+	uint64_t bytes{ 0 };
+	uint64_t packets{ 0 };
+	uint64_t errors{ 0 };
+	uint64_t lost{ 0 };
+	const histogram_sample_t * latency{ nullptr }; // rtt (ping-pong) or one-way delay (udp rx) of the interval
+
+	static const char * csv_header()
+	{
+		return "time_ms,elapsed_ms,interval_ms,role,direction,link,server,client,port,bytes,packets,errors,lost,mbps,pps,p50_us,p90_us,p99_us,p999_us";
+	}
+
+	std::string to_csv() const
+	{
+		char line[512];
+		int len = snprintf(line, sizeof(line), "%lld,%lld,%lld,%s,%s,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.3lf,%.0lf,",
+			time_ms, elapsed_ms, interval_ms, role, direction, (unsigned long long)link_id, (unsigned long long)server_id,
+			(unsigned long long)client_id, (unsigned long long)port_id, (unsigned long long)bytes, (unsigned long long)packets,
+			(unsigned long long)errors, (unsigned long long)lost, mbps(), pps());
+
+		if (has_latency())
+		{
+			snprintf(line + len, sizeof(line) - len, "%.1lf,%.1lf,%.1lf,%.1lf", latency->quantile(0.5) / 1000.,
+				latency->quantile(0.9) / 1000., latency->quantile(0.99) / 1000., latency->quantile(0.999) / 1000.);
+		}
+		else
+			snprintf(line + len, sizeof(line) - len, ",,,");
+
+		return line;
+	}
+
+	std::string to_json() const
+	{
+		char line[512];
+		int len = snprintf(line, sizeof(line), "{\"time_ms\": %lld, \"elapsed_ms\": %lld, \"interval_ms\": %lld, \"role\": \"%s\", \"direction\": \"%s\", \"link\": %llu, "
+			"\"server\": %llu, \"client\": %llu, \"port\": %llu, \"bytes\": %llu, \"packets\": %llu, \"errors\": %llu, \"lost\": %llu, "
+			"\"mbps\": %.3lf, \"pps\": %.0lf", time_ms, elapsed_ms, interval_ms, role, direction, (unsigned long long)link_id,
+			(unsigned long long)server_id, (unsigned long long)client_id, (unsigned long long)port_id, (unsigned long long)bytes,
+			(unsigned long long)packets, (unsigned long long)errors, (unsigned long long)lost, mbps(), pps());
+
+		if (has_latency())
+		{
+			len += snprintf(line + len, sizeof(line) - len, ", \"p50_us\": %.1lf, \"p90_us\": %.1lf, \"p99_us\": %.1lf, \"p999_us\": %.1lf",
+				latency->quantile(0.5) / 1000., latency->quantile(0.9) / 1000., latency->quantile(0.99) / 1000.,
+				latency->quantile(0.999) / 1000.);
+		}
+
+		snprintf(line + len, sizeof(line) - len, "}");
+
+		return line;
+	}
+
+private:
+	inline bool has_latency() const { return (latency != nullptr) && (latency->count() > 0); }
+	inline double mbps() const { return interval_ms > 0 ? (bytes * 8.) / (interval_ms * 1000.) : 0.; }
+	inline double pps() const { return interval_ms > 0 ? (packets * 1000.) / interval_ms : 0.; }
+};
+
+#endif // !_INTERVAL_RECORD_HPP_
@@ -0,0 +1,196 @@
+#ifndef _LINK_STATS_HPP_
+#define _LINK_STATS_HPP_
+
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <stdint.h>
+
+#define CACHE_LINE_SIZE 64
+
+struct link_sample_t
+{
+	uint64_t packets{ 0 };
+	uint64_t bytes{ 0 };
+	uint64_t errors{ 0 };
+	uint64_t seq_gaps{ 0 };
+	uint64_t reordered{ 0 };
+	uint64_t reorder_distance{ 0 }; // sum over reordered packets
+	uint64_t lost{ 0 };
+	uint64_t duplicated{ 0 };
+	uint64_t late{ 0 };
+	uint64_t zerocopy_copied{ 0 }; // zero-copy sends the kernel completed by copying
+
+	// gauges, not differenced
+	uint64_t jitter_ns{ 0 };
+	uint64_t reorder_max{ 0 };
+	uint64_t missing{ 0 }; // sequence numbers behind the highest one received not seen yet
+
+	link_sample_t operator-(const link_sample_t & other) const
+	{
+		link_sample_t delta{ *this };
+		delta.packets = packets - other.packets;
+		delta.bytes = bytes - other.bytes;
+		delta.errors = errors - other.errors;
+		delta.seq_gaps = seq_gaps - other.seq_gaps;
+		delta.reordered = reordered - other.reordered;
+		delta.reorder_distance = reorder_distance - other.reorder_distance;
+		delta.lost = lost - other.lost;
+		delta.duplicated = duplicated - other.duplicated;
+		delta.late = late - other.late;
+		delta.zerocopy_copied = zerocopy_copied - other.zerocopy_copied;
+
+		return delta;
+	}
+
+	link_sample_t & operator+=(const link_sample_t & other)
+	{
+		packets += other.packets;
+		bytes += other.bytes;
+		errors += other.errors;
+		seq_gaps += other.seq_gaps;
+		reordered += other.reordered;
+		reorder_distance += other.reorder_distance;
+		lost += other.lost;
+		duplicated += other.duplicated;
+		late += other.late;
+		zerocopy_copied += other.zerocopy_copied;
+		jitter_ns += other.jitter_ns;
+		missing += other.missing;
+		reorder_max = (reorder_max > other.reorder_max ? reorder_max : other.reorder_max);
+
+		return *this;
+	}
+};
+
+// statistics of one link, owned by a single writer thread and read by the reporter
+struct alignas(CACHE_LINE_SIZE) link_stats_t
+{
+	std::atomic<uint64_t> packets{ 0 };
+	std::atomic<uint64_t> bytes{ 0 };
+	std::atomic<uint64_t> errors{ 0 };
+	std::atomic<uint64_t> seq_gaps{ 0 };
+	std::atomic<uint64_t> reordered{ 0 };
+	std::atomic<uint64_t> reorder_distance{ 0 };
+	std::atomic<uint64_t> lost{ 0 };
+	std::atomic<uint64_t> duplicated{ 0 };
+	std::atomic<uint64_t> late{ 0 };
+	std::atomic<uint64_t> zerocopy_copied{ 0 };
+	std::atomic<uint64_t> jitter_ns{ 0 };
+	std::atomic<uint64_t> reorder_max{ 0 }; // since the last take_reorder_max()
+	std::atomic<uint64_t> missing{ 0 };
+
+	// link identity, written once before the test starts
+	std::size_t server_id{ 0 };
+	std::size_t client_id{ 0 };
+	std::size_t port_id{ 0 };
+	bool zerocopy{ false };
+	int cpu{ -1 }; // pinned cpu, -1 if unpinned
+	std::atomic<int64_t> start_ns{ 0 }; // steady clock time the link thread passed the start barrier, 0 before
+
+	inline void add_packets(const uint64_t count, const uint64_t size)
+	{
+		add(packets, count);
+		add(bytes, count * size);
+	}
+
+	inline void add_error() { add(errors, 1); }
+	inline void add_seq_gap() { add(seq_gaps, 1); }
+	inline void add_lost(const uint64_t count) { add(lost, count); }
+	inline void add_duplicate() { add(duplicated, 1); }
+	inline void add_late() { add(late, 1); }
+	inline void set_zerocopy_copied(const uint64_t total) { zerocopy_copied.store(total, std::memory_order_relaxed); }
+	inline void set_jitter(const uint64_t _jitter_ns) { jitter_ns.store(_jitter_ns, std::memory_order_relaxed); }
+	inline void set_missing(const uint64_t count) { missing.store(count, std::memory_order_relaxed); }
+
+	inline void add_reorder(const uint64_t distance)
+	{
+		add(reordered, 1);
+		add(reorder_distance, distance);
+
+		// the reporter resets reorder_max, so this one needs a real compare-and-swap (reorders are rare)
+		uint64_t current{ reorder_max.load(std::memory_order_relaxed) };
+		while ((distance > current) && !reorder_max.compare_exchange_weak(current, distance, std::memory_order_relaxed));
+	}
+
+	// reporter side: maximum reorder distance since the previous call
+	inline uint64_t take_reorder_max() { return reorder_max.exchange(0, std::memory_order_relaxed); }
+
+	link_sample_t sample() const
+	{
+		link_sample_t snapshot;
+		snapshot.packets = packets.load(std::memory_order_relaxed);
+		snapshot.bytes = bytes.load(std::memory_order_relaxed);
+		snapshot.errors = errors.load(std::memory_order_relaxed);
+		snapshot.seq_gaps = seq_gaps.load(std::memory_order_relaxed);
+		snapshot.reordered = reordered.load(std::memory_order_relaxed);
+		snapshot.reorder_distance = reorder_distance.load(std::memory_order_relaxed);
+		snapshot.lost = lost.load(std::memory_order_relaxed);
+		snapshot.duplicated = duplicated.load(std::memory_order_relaxed);
+		snapshot.late = late.load(std::memory_order_relaxed);
+		snapshot.zerocopy_copied = zerocopy_copied.load(std::memory_order_relaxed);
+		snapshot.jitter_ns = jitter_ns.load(std::memory_order_relaxed);
+		snapshot.missing = missing.load(std::memory_order_relaxed);
+
+		return snapshot;
+	}
+
+private:
+	// single writer, so a relaxed load/store pair replaces the locked read-modify-write
+	static inline void add(std::atomic<uint64_t> & counter, const uint64_t value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+};
+
+static_assert(sizeof(link_stats_t) % CACHE_LINE_SIZE == 0, "link_stats_t must fill whole cache lines!");
+
+// cache line aligned array of link_stats_t (operator new[] does not honor alignas before c++17)
+class link_stats_table_t
+{
+public:
+	link_stats_table_t() = default;
+	link_stats_table_t(const link_stats_table_t&) = delete;
+	link_stats_table_t& operator=(const link_stats_table_t&) = delete;
+
+	void resize(const std::size_t _size)
+	{
+		clear();
+
+		memory_ = malloc(_size * sizeof(link_stats_t) + CACHE_LINE_SIZE);
+		stats_ = (link_stats_t*)(((uintptr_t)memory_ + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1));
+		size_ = _size;
+
+		for (std::size_t i = 0; i < size_; ++i)
+			new (&stats_[i]) link_stats_t();
+	}
+
+	void clear()
+	{
+		for (std::size_t i = 0; i < size_; ++i)
+			stats_[i].~link_stats_t();
+
+		free(memory_);
+		memory_ = nullptr;
+		stats_ = nullptr;
+		size_ = 0;
+	}
+
+	inline std::size_t size() const { return size_; }
+
+	inline link_stats_t & operator[](const std::size_t index) { return stats_[index]; }
+	inline const link_stats_t & operator[](const std::size_t index) const { return stats_[index]; }
+
+	~link_stats_table_t()
+	{
+		clear();
+	}
+
+private:
+	void * memory_{ nullptr };
+	link_stats_t * stats_{ nullptr };
+	std::size_t size_{ 0 };
+};
+
+#endif // !_LINK_STATS_HPP_
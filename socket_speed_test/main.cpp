@@ -1,325 +1,3406 @@
 #include "pch.h"
 
 #include "util/sockio.h"
+#include "util/poller.h"
+#include "util/uring.h"
+#include "util/zerocopy_ring.h"
+#include "util/histogram.h"
+#include "util/cpu_usage.h"
+#include "util/buffer_pool.h"
+#include "util/pacer.h"
+#include "util/cpu_affinity.h"
 #include "util/resettable_event.h"
+#include "util/link_barrier.h"
+#include "util/record_sink.h"
+#include "util/control_channel.h"
 #include "speed_test_config.hpp"
+#include "packet_header.hpp"
+#include "link_stats.hpp"
+#include "udp_flow.hpp"
+#include "sweep_result.hpp"
+#include "steady_state.hpp"
+#include "interval_record.hpp"
 
 #define MAX_UDP_PACKET_SIZE 0xffff
 #define CONFIG_FILE_ADDRESS "./../speed_test_config.cfg"
+#define MAX_POLL_EVENTS 64
+#define MAX_POLL_PACKETS 64 // per link and wakeup, keeps workers fair between links
+#define POLL_TIMEOUT_MS 100
+#define URING_CANCEL_KEY (~0ull)
+#define PING_TIMEOUT_MS 1000
+#define ZEROCOPY_DRAIN_MS 1000
+#define TIMED_TX_LINGER_MS 1000
+#define TIMED_RX_ECHO_MS 5000 // a timed rx that answers pings keeps its links up past its window until the tx peer closed, at most this long
+#define STOP_WAIT_MS 1000 // link threads still running after the shutdown by then are not waited for
+#define SWEEP_CELL_GAP_MS 2000 // tx pause between cells, rx is bound again by then
+#define CHURN_BACKLOG 4096 // the kernel caps it at net.core.somaxconn
+#define CONTROL_CONNECT_MS 10000 // a tx peer retries its control connection while rx finishes the previous test
+#define CONTROL_MAX_PORT_COUNT 0xffff // per client, a setup asking for more is rejected
+#define BUFFER_ALIGNMENT 64 // buffer_pool_t rounds every allocation up to it
+#define PACING_BURST_SENDS 4 // a paced link that fell behind catches up by at most this many send calls
 
 using namespace std::chrono;
 using namespace std::literals::chrono_literals;
 
 static speed_test_config_t config{ "Test Config" };
-static std::thread * threads;
-static std::size_t n_connection{ 0 };
+static record_sink_t records;
+static control_channel_t control; // the test in progress between a tx peer and its rx peer
 
-static bool keep_on{ true };
-static std::atomic_llong pack_cnt{ 0 };
-static std::atomic_int connection_cnt{ 0 };
-static resettable_event<false> ready{ false };
-static resettable_event<false> start{ false };
+struct rx_link_t
+{
+	std::size_t server_id;
+	std::size_t client_id;
+	std::size_t port_id;
+
+	char * packet{ nullptr };
+	int offset{ 0 };
+	int32_t local_pack_cnt{ 0 };
+	udp_flow_t flow;
+};
+
+// previous samples of the interval reporter, reset for every run
+struct report_state_t
+{
+	uint64_t syscall_cnt{ 0 };
+	std::vector<link_sample_t> last_sample;
+	histogram_sample_t last_rtt;
+	histogram_sample_t last_owd;
+	histogram_sample_t last_connect;
+	cpu_time_t last_process_time;
+	std::vector<uint64_t> last_thread_ns;
+	std::vector<uint64_t> last_thread_bytes;
+	std::vector<histogram_sample_t> last_link_latency; // only with interval records
+	std::vector<link_sample_t> last_reverse_sample; // only in full duplex
+	std::vector<uint64_t> last_reverse_thread_ns;
+	long long elapsed_ms{ 0 };
+	bool start_reported{ false };
+};
+
+// duration_ms = 0 runs until the user presses enter, otherwise warm-up and measured window are timed
+struct run_plan_t
+{
+	long long duration_ms{ 0 };
+	long long warmup_ms{ 0 };
+	long long interval_ms{ 2500 };
+	int steady_intervals{ 0 }; // ends a timed run early once throughput is steady, 0: off
+	double steady_deviation{ 0. };
+};
+
+// one side of a test (tx, rx or ping-pong) with its own links, threads, counters and events;
+// the "both" mode runs a tx and an rx role against each other in one process
+class test_role_t
+{
+public:
+	test_role_t(const speed_test_config_t & _config, const speed_test_config_t::test_mode_t _mode, const bool _tagged);
+	test_role_t(const test_role_t&) = delete;
+	test_role_t& operator=(const test_role_t&) = delete;
+	~test_role_t();
+
+	// placement_offset shifts automatic cpu placement, so two roles do not share their first cpus
+	void setup(const std::size_t _placement_offset);
+	void launch();
+	void wait_ready();
+	void begin();
+	void shutdown();
+	void close();
+
+	inline void wait_listening() const { listening.wait(); }
+	inline void stop() { keep_on = false; }
+	inline bool running() const { return keep_on; }
+	inline bool echoing() const { return echoed; }
+	// the measured window is over, links whose peer closes from now on end quietly
+	inline void close_window() { window_closed = true; }
+
+	void take_snapshot(run_result_t & snapshot, const long long ms);
+	uint64_t total_bytes();
+	void report(const long long ms);
+	void report_summary(const long long ms);
+	void report_stop_skew();
+	void add_link_results(control_message_t & message);
+	void report_peer(const control_message_t & peer, const run_result_t & window);
+
+	// placement slots taken by this role, a full duplex link has a reverse thread as well
+	inline std::size_t thread_count() const { return reverse_threads != nullptr ? 2 * n_connection : n_connection; }
+	inline speed_test_config_t::test_mode_t mode() const { return config.mode(); }
+	const char * name() const;
+
+private:
+	void tx_start();
+	void rx_udp_start();
+	void rx_tcp_start();
+	void rx_poll_start();
+	void rx_churn_start();
+	void rx_tcp_accept(tcp_server_t * servers, std::size_t server_id, std::size_t first_link);
+
+	void tx_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
+	void rx_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
+	void rx_poll_core(std::size_t worker_id);
+	void tx_churn_core(std::size_t server_id, std::size_t client_id, std::size_t link_id);
+	void rx_churn_core(std::size_t link_id);
+	void tx_uring_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id, int & local_pack_cnt);
+	void rx_uring_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
+	void tx_batch_core(std::size_t link_id, int & local_pack_cnt);
+	void pace_start(std::size_t link_id);
+	void tx_zerocopy_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id, int & local_pack_cnt);
+	void rx_batch_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
+	bool rx_poll_drain(rx_link_t & link, std::size_t link_id);
+	void ping_core(std::size_t link_id, char * packet);
+	void duplex_start(std::size_t link_id);
+	std::thread * reverse_thread(std::size_t link_id) const;
+	void duplex_tx_core(std::size_t link_id);
+	void duplex_rx_core(std::size_t link_id);
+	void wait_start(std::size_t link_id);
+	bool rx_reject_ping(const char * packet);
+	void record_interval(const std::size_t con_id, const link_sample_t & delta, const long long ms, const histogram_sample_t * latency,
+		const bool reverse = false);
+	void report_histogram(const char * title, const histogram_t * hist, histogram_sample_t & last_sample);
+	void report_overall(const char * title, const histogram_t * hist);
+	void report_cpu_overall(const long long ms);
+	inline const char * process_cpu_prefix() const;
+	void report_time_wait();
+	void report_start_skew();
+	void report_pacing(const char * prefix, const uint64_t bytes, const long long ms, const std::size_t links);
+	int rx_udp_create(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id);
+	void set_link_identity(std::size_t link_id, std::size_t server_id, std::size_t client_id, std::size_t port_id);
+	void placement_init();
+	int placement_cpu(std::size_t link_id, std::size_t server_id, std::size_t client_id, std::size_t port_id);
+	void report_placement();
+	void report_socket_options();
+	inline bool rx_use_poller();
+	inline bool use_uring();
+	inline bool use_udp_batch();
+	inline bool use_zerocopy(const std::size_t link_id);
+	inline bool use_duplex();
+	inline bool use_churn();
+	inline void pace(const std::size_t link_id, const std::size_t bytes);
+	inline const histogram_t * latency_hist() const;
+	inline int ping_response_len();
+	std::size_t buffer_slab_size();
+	char * link_buffer(const std::size_t slab_id, const std::size_t size);
+	const char * direction(const bool reverse) const;
+	bool get_client_id(const socket_t & link, const std::size_t server_id, std::size_t & client_id);
+
+	// a copy of the test config with this role's mode, it shadows the global one in every member
+	speed_test_config_t config;
+	bool tagged{ false }; // output lines carry the role name
 
-static socket_t * connection{ nullptr };
+	std::thread * threads{ nullptr };
+	std::size_t n_connection{ 0 };
+	socket_t * connection{ nullptr };
 
-static void tx_start();
-static void rx_udp_start();
-static void rx_tcp_start();
+	bool keep_on{ true };
+	bool echoed{ false }; // an rx link answered a ping
+	bool window_closed{ false };
+	link_stats_table_t stats;
+	std::thread * reverse_threads{ nullptr }; // full duplex: the opposite direction of every link, on the same socket
+	std::atomic<bool> * reverse_started{ nullptr }; // the link thread sets it once it assigned its reverse thread
+	link_stats_table_t reverse_stats;
+	histogram_t * rtt_hist{ nullptr };
+	histogram_t * owd_hist{ nullptr };
+	histogram_t * connect_hist{ nullptr }; // churn tx: connect (and exchange) time of every connection
+	tcp_server_t * churn_servers{ nullptr }; // churn rx: one SO_REUSEPORT listener per acceptor thread
+	buffer_pool_t buffer_pool; // one slab per link thread (reverse links take the second half in full duplex)
+	pacer_t * pacers{ nullptr }; // only for paced tx links, kernel paced links leave theirs disabled
+	double pace_bytes_per_s{ 0. }; // target of every paced link
+	cpu_time_t run_cpu_time;
+	std::vector<int> auto_cpus;
+	std::size_t placement_offset{ 0 };
+	std::atomic_int connection_cnt{ 0 };
+	resettable_event<false> listening{ false };
+	resettable_event<false> ready{ false };
+	start_barrier_t start;
+	stop_barrier_t stopped; // every link, reverse link and rx worker thread
 
-static void tx_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
-static void rx_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id);
-static bool get_client_id(const socket_t & link, const std::size_t server_id, std::size_t & client_id);
+	rx_link_t * rx_link{ nullptr };
+	poller_t * poller{ nullptr };
+	std::size_t n_poller{ 0 };
+
+	report_state_t report_state;
+};
+
+static int run_test(const run_plan_t & plan, run_result_t & result);
+static bool valid_pack_len(const speed_test_config_t::ip_protocol_t protocol, const long long pack_len);
+static bool validate_config();
+static void run_sweep();
+static void run_control_server();
+static int control_connect(const run_plan_t & plan);
+static bool control_apply(const control_message_t & setup, std::string & reason);
+static void run_search();
+static bool search_trial(const run_plan_t & plan, const double rate, int & trials, run_result_t & result);
+
+static inline bool running(const std::vector<std::unique_ptr<test_role_t>> & roles);
+static inline void stop(std::vector<std::unique_ptr<test_role_t>> & roles);
+static void uring_cancel(uring_t & ring, const unsigned depth, const bool all);
+static void uring_drain(uring_t & ring, unsigned in_flight, const unsigned depth);
+static void report_latency(const char * title, const histogram_sample_t & sample, const uint64_t max);
+static inline double loss_percent(const link_sample_t & sample);
+static void report_cpu(const char * prefix, const uint64_t cpu_ns, const uint64_t bytes, const long long ms);
+static void report_memory(const char * prefix, const cpu_time_t & cpu_delta);
+static inline bool rx_check_sequence(const char * packet, int32_t & local_pack_cnt);
+static inline void tx_stamp(char * packet, int & local_pack_cnt, const bool is_udp);
+static void pin_thread(const char * name, std::size_t index, int cpu);
 
 int main()
 {
 	INIT();
 
-	config.scan(config.read_file(CONFIG_FILE_ADDRESS));
-	config.write_file(CONFIG_FILE_ADDRESS);
+	// timed runs and sweeps take a valid config file as is and never wait for the user
+	const bool read{ config.read_file(CONFIG_FILE_ADDRESS) };
+	const bool serving{ config.control() && (config.mode() == speed_test_config_t::test_mode_t::rx) };
+	const bool interactive{ !config.run().timed() && !config.sweep().enabled() && !config.search().enabled() && !serving };
 
-	assert((config.protocol() == speed_test_config_t::ip_protocol_t::tcp) || (config.pack_len() <= MAX_UDP_PACKET_SIZE));
+	if (read && !interactive)
+		config.print();
+	else
+		config.scan(read);
 
-	For(srv_id, config.server_count())
+	config.write_file(CONFIG_FILE_ADDRESS);
+
+	// a controlled rx takes the packet lengths of its tx peers, control_apply() checks them
+	if (!serving && !validate_config())
 	{
-		For(cli_id, config.server(srv_id).client_count())
-			n_connection += config.server(srv_id).client(cli_id).port_count();
+		FINISH_WAIT(1, interactive);
 	}
 
-	printf("\nestablishing connection... \n");
-
-	threads = new std::thread[n_connection];
-	connection = new socket_t[n_connection];
-
-	if (config.mode() == speed_test_config_t::test_mode_t::tx)
-		tx_start();
-	else if (config.mode() == speed_test_config_t::test_mode_t::rx)
+	if (!config.run().record_file().empty())
 	{
-		if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
-			rx_udp_start();
-		else
-			rx_tcp_start();
+		const bool csv{ config.run().record_format() == run_config_t::record_format_t::csv };
+
+		int ret = records.open(config.run().record_file(), csv ? interval_record_t::csv_header() : "");
+		if (ret != 0)
+			printf("interval record file '%s' can not be written! (Error Code: %d) \n", config.run().record_file().c_str(), ret);
 	}
-	else
-		throw new std::invalid_argument("Invalid Test Mode!");
 
-	if (keep_on)
+	// inherited by the test threads, so it is opened before the first of them starts
+	if ((cpu_usage::open_tlb_counter() != 0) && config.huge_pages())
+		printf("data tlb misses can not be counted (perf events not permitted)... \n");
+
+	if (serving)
+		run_control_server();
+	else if (config.sweep().enabled())
+		run_sweep();
+	else if (config.search().enabled())
+		run_search();
+	else
 	{
-		ready.wait();
-		printf("connection established... \n");
+		run_plan_t plan;
+		plan.duration_ms = MAX(config.run().duration(), 0);
+		plan.warmup_ms = MAX(config.run().warmup(), 0);
+		plan.interval_ms = MAX(config.run().report_interval(), 1);
+		plan.steady_intervals = MAX(config.run().steady_intervals(), 0);
+		plan.steady_deviation = config.run().steady_deviation();
+
+		run_result_t result;
+		run_test(plan, result);
 	}
 
-	std::thread wait_for_user_thread = std::thread([](bool & keep_on)
-	{
-		if (keep_on)
-			std::this_thread::sleep_for(1500ms);
+	records.close();
 
-		printf("press enter to exit... \n\n");
-		GET_CHAR();
-		keep_on = false;
-	}, std::ref(keep_on));
+	FINISH_WAIT(0, interactive);
+}
 
-	auto start_time = high_resolution_clock::now();
-	start.set();
+static int run_test(const run_plan_t & plan, run_result_t & result)
+{
+	assert((config.protocol() == speed_test_config_t::ip_protocol_t::tcp) || (config.pack_len() <= MAX_UDP_PACKET_SIZE));
+	assert(config.pack_len() >= (int)sizeof(packet_header_t));
 
-	while (keep_on)
+	// "both" runs tx and rx in this process; the rx role is the measured one, as the receiver sees what arrived
+	std::vector<std::unique_ptr<test_role_t>> roles;
+	if (config.mode() == speed_test_config_t::test_mode_t::both)
 	{
-		std::this_thread::sleep_for(2500ms);
-		if (!keep_on)
-			break;
+		roles.emplace_back(new test_role_t(config, speed_test_config_t::test_mode_t::tx, true));
+		roles.emplace_back(new test_role_t(config, speed_test_config_t::test_mode_t::rx, true));
+	}
+	else
+		roles.emplace_back(new test_role_t(config, config.mode(), false));
 
-		const auto now = high_resolution_clock::now();
-		const auto ms = duration_cast<milliseconds>(now - start_time).count();
-		start_time = now;
+	test_role_t & measured_role{ *roles.back() };
 
-		printf("%3.3lf Mbps \n\n", (pack_cnt.exchange(0ll) * config.pack_len() * 8.) / (ms * 1000.));
+	// a control channel joins separate processes, rx already accepted it when the tx peer asked for this test
+	if (config.control() && (roles.size() == 1) && (measured_role.mode() != speed_test_config_t::test_mode_t::rx))
+	{
+		int ret = control_connect(plan);
+		if (ret != 0)
+			return ret;
 	}
 
-	wait_for_user_thread.join();
+	const bool controlled{ control.is_open() && (roles.size() == 1) };
+	const bool control_rx{ controlled && (measured_role.mode() == speed_test_config_t::test_mode_t::rx) };
 
-	For(con_id, n_connection)
-		connection[con_id].close();
+	printf("\nestablishing connection... \n");
 
-	For(con_id, n_connection)
+	std::size_t placement_offset{ 0 };
+	For(role_id, roles.size())
 	{
-		if (threads[con_id].joinable())
-			threads[con_id].join();
+		roles[role_id]->setup(placement_offset);
+		placement_offset += roles[role_id]->thread_count();
 	}
 
-	delete[] threads;
-	delete[] connection;
+	// the rx role blocks in its accept loop, so with two roles (or a tx peer waiting for it) it listens on a
+	// helper thread before tx connects
+	std::thread launcher;
+	if ((roles.size() > 1) || control_rx)
+	{
+		launcher = std::thread(&test_role_t::launch, roles.back().get());
+		roles.back()->wait_listening();
+	}
 
-	FINISH(0);
-}
+	if (control_rx)
+	{
+		control_message_t reply(measured_role.running() ? "ready" : "reject");
+		if (!measured_role.running())
+			reply.set("reason", "rx links could not listen");
 
-static void tx_start()
-{
-	std::size_t con_id{ 0 };
+		control.send(reply);
+	}
 
-	For(srv_id, config.server_count())
+	For(role_id, roles.size() - (launcher.joinable() ? 1 : 0))
+		roles[role_id]->launch();
+
+	For(role_id, roles.size())
+		roles[role_id]->wait_ready();
+
+	if (launcher.joinable())
+		launcher.join();
+
+	// rx is up last (its tcp links are accepted once tx connected, its udp links bind on their own threads),
+	// so it tells the tx peer when both can begin
+	if (control_rx)
+		control.send(control_message_t("start"));
+	else if (controlled)
 	{
-		For(cli_id, config.server(srv_id).client_count())
+		control_message_t message;
+		while ((control.recv(message) == 0) && !message.is("start"));
+
+		if (!message.is("start"))
 		{
-			For(prt_id, config.server(srv_id).client(cli_id).port_count())
-			{
-				threads[con_id] = std::thread(tx_core, srv_id, cli_id, prt_id, con_id);
-				++con_id;
-			}
+			printf("rx peer closed the control channel before the start... \n");
+			stop(roles);
 		}
 	}
-}
 
-static void rx_udp_start()
-{
-	std::size_t con_id{ 0 };
+	const bool timed{ plan.duration_ms > 0 };
+	std::thread wait_for_user_thread;
 
-	For(srv_id, config.server_count())
+	// the tx peer ends a controlled rx, its stop arrives when its own window is over or the user pressed enter
+	if (control_rx)
 	{
-		For(cli_id, config.server(srv_id).client_count())
+		wait_for_user_thread = std::thread([&roles]()
 		{
-			For(prt_id, config.server(srv_id).client(cli_id).port_count())
-			{
-				threads[con_id] = std::thread(rx_core, std::ref(connection[con_id]), srv_id, cli_id, prt_id, con_id);
-				++con_id;
-			}
-		}
+			control_message_t message;
+			while ((control.recv(message) == 0) && !message.is("stop"));
+
+			stop(roles);
+		});
 	}
-}
+	else if (!timed)
+	{
+		wait_for_user_thread = std::thread([&roles]()
+		{
+			if (running(roles))
+				std::this_thread::sleep_for(1500ms);
 
-static void rx_tcp_start()
-{
-	std::size_t cnt{ 0 };
+			printf("press enter to exit... \n\n");
+			GET_CHAR();
+			stop(roles);
+		});
+	}
 
-	For(srv_id, config.server_count())
+	cpu_usage::cycles_per_ns(); // calibrates once, outside of the measured intervals
+
+	For(role_id, roles.size())
+		roles[role_id]->begin();
+
+	// a timed rx starts its clock with the first packet, so both peers measure the same window
+	if (timed && (roles.size() == 1) && (measured_role.mode() == speed_test_config_t::test_mode_t::rx))
 	{
-		tcp_server_t server;
-		int ret = server.create(config.server(srv_id).ip_address(), (uint16_t)config.server(srv_id).port());
-		if (ret != 0)
+		run_result_t first;
+		do
 		{
-			printf("%lluth server 'create' method failed on (%s %d) (Error Code: %d) \n",
-				srv_id + 1, config.server(srv_id).ip_address().c_str(), config.server(srv_id).port(), ret);
+			std::this_thread::sleep_for(1ms);
+			measured_role.take_snapshot(first, 0);
+		} while (running(roles) && (first.packets == 0));
+	}
 
-			keep_on = false;
-			break;
-		}
+	auto start_time = high_resolution_clock::now();
+	const auto run_start_time = start_time;
+	const auto warmup_end_time = run_start_time + milliseconds(plan.warmup_ms);
+	const auto measure_end_time = warmup_end_time + milliseconds(plan.duration_ms);
 
-		For(cli_id, config.server(srv_id).client_count())
-		{
-			std::size_t port_id{ 0 };
-			For(prt_id, config.server(srv_id).client(cli_id).port_count())
-			{
-				while (keep_on)
-				{
-					int ret = server.listen(connection[cnt], (int)n_connection);
-					if (ret != 0)
-					{
-						printf("%llu server 'listen' method failed on (%s %d) (Error Code: %d) \n",
-							srv_id + 1, config.server(srv_id).ip_address().c_str(), config.server(srv_id).port(), ret);
+	auto echo_end_time = measure_end_time;
 
-						keep_on = false;
-						break;
-					}
+	run_result_t baseline, finish;
+	bool warmed_up{ !timed || (plan.warmup_ms <= 0) };
+	bool measured{ false };
+	bool echo_wait{ false };
 
-					std::size_t client_id;
-					if (!get_client_id(connection[cnt], srv_id, client_id))
-					{
-						printf("Unknown Client (%s, %d) \n", connection[cnt].pair_ip().c_str(), connection[cnt].pair_port());
-						connection[cnt].close();
-					}
-					else
-					{
-						threads[cnt] = std::thread(rx_core, std::ref(connection[cnt]), srv_id, client_id, port_id, cnt);
-						++cnt;
-						++port_id;
-						break;
-					}
-				}
-			}
-		}
+	steady_state_t steady{ timed ? (std::size_t)plan.steady_intervals : 0, plan.steady_deviation };
+	uint64_t last_bytes{ measured_role.total_bytes() };
 
-		server.close();
-	}
-}
+	measured_role.take_snapshot(baseline, 0);
 
-static void tx_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
-{
-	char * packet = new char[8 + config.pack_len() - config.pack_len() % 8];
-	int local_pack_cnt{ 0 };
+	while (running(roles))
+	{
+		auto wake_time = start_time + milliseconds(plan.interval_ms);
+		if (timed && !measured)
+			wake_time = MIN(wake_time, !warmed_up ? warmup_end_time : measure_end_time);
+		else if (echo_wait)
+			wake_time = MIN(wake_time, echo_end_time);
 
-	memset(packet, 0, config.pack_len());
+		std::this_thread::sleep_until(wake_time);
+		if (!running(roles))
+			break;
 
-	int ret;
-	do {
-		ret = connection[link_id].create(
-			config.protocol() == speed_test_config_t::ip_protocol_t::tcp ? ip_protocol_t::tcp : ip_protocol_t::udp,
-			config.server(server_id).client(client_id).ip_address());
+		const auto now = high_resolution_clock::now();
 
-		if (ret != 0)
+		if (!warmed_up && (now >= warmup_end_time))
 		{
-			printf("%lluth port of %lluth client of %lluth server: 'create' method failed! (Error Code: %d) \n",
-				port_id + 1, client_id + 1, server_id + 1, ret);
+			measured_role.take_snapshot(baseline, duration_cast<milliseconds>(now - run_start_time).count());
+			warmed_up = true;
 		}
-		else
+
+		if (timed && warmed_up && !measured && (now >= measure_end_time))
 		{
-			uint16_t server_port{ (uint16_t)config.server(server_id).port() };
-			if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
-				server_port += (uint16_t)port_id;
+			measured_role.take_snapshot(finish, duration_cast<milliseconds>(now - run_start_time).count());
+			measured = true;
+		}
 
-			ret = connection[link_id].connect(config.server(server_id).ip_address(), server_port);
-			if (ret != 0)
+		if (now - start_time >= milliseconds(plan.interval_ms))
+		{
+			const auto ms = duration_cast<milliseconds>(now - start_time).count();
+			const bool warm_interval{ warmed_up && (start_time >= warmup_end_time) };
+			start_time = now;
+
+			For(role_id, roles.size())
+				roles[role_id]->report(ms);
+
+			// only intervals entirely after the warm-up count towards the steady state
+			const uint64_t bytes{ measured_role.total_bytes() };
+			if (warm_interval && !measured && steady.add((bytes - last_bytes) * 8. / (ms * 1000.)))
 			{
-				printf("%lluth port of %lluth client of %lluth server: 'connect' method failed! (Error Code: %d) \n",
-					port_id + 1, client_id + 1, server_id + 1, ret);
+				printf("steady state after %lld ms: %.2lf%% deviation over %llu intervals \n",
+					(long long)duration_cast<milliseconds>(now - warmup_end_time).count(), steady.deviation(), (unsigned long long)steady.size());
+
+				measured_role.take_snapshot(finish, duration_cast<milliseconds>(now - run_start_time).count());
+				measured = true;
 			}
-			else
-			{
-				if (connection_cnt.fetch_add(1) + 1 == (int)n_connection)
-					ready.set();
 
-				start.wait();
-				break;
+			last_bytes = bytes;
+		}
+
+		// a ping-pong tx may still be inside its own window, so an rx that answered pings stays up until the tx closed the links
+		if (measured && !echo_wait)
+		{
+			if ((roles.size() == 1) && (measured_role.mode() == speed_test_config_t::test_mode_t::rx) && measured_role.echoing())
+			{
+				measured_role.close_window();
+				echo_end_time = now + milliseconds(TIMED_RX_ECHO_MS);
+				echo_wait = true;
 			}
+			else
+				stop(roles);
+		}
+		else if (echo_wait && (now >= echo_end_time))
+		{
+			printf("tx peer still running %d ms after the window, stopping... \n", TIMED_RX_ECHO_MS);
+			stop(roles);
 		}
+	}
 
-		std::this_thread::sleep_for(750ms);
-	} while (true);
+	// interactive runs and runs cut short by an error are measured up to here
+	if (!measured)
+		measured_role.take_snapshot(finish, duration_cast<milliseconds>(high_resolution_clock::now() - run_start_time).count());
 
-	while (keep_on)
+	result = finish - baseline;
+
+	if (wait_for_user_thread.joinable() && !control_rx)
+		wait_for_user_thread.join();
+
+	For(role_id, roles.size())
+		roles[role_id]->report_summary(duration_cast<milliseconds>(high_resolution_clock::now() - run_start_time).count());
+
+	// rx hands its window over as soon as it has one, then keeps its links up until the tx peer stopped as well
+	if (control_rx)
 	{
-		*(int32_t*)packet = (local_pack_cnt > (1 << 30) ? local_pack_cnt = 0 : local_pack_cnt)++;
+		control_message_t message("result");
+		message.set("ms", result.ms);
+		message.set("packets", (long long)result.packets);
+		message.set("bytes", (long long)result.bytes);
+		message.set("errors", (long long)result.errors);
+		message.set("lost", (long long)result.lost);
+		message.set("missing", (long long)result.missing);
+		message.set("cpu_user_ns", (long long)result.cpu.user_ns);
+		message.set("cpu_sys_ns", (long long)result.cpu.sys_ns);
+		measured_role.add_link_results(message);
 
-		ret = connection[link_id].send(packet, (int)config.pack_len());
-		if (ret != 0)
+		control.send(message);
+		wait_for_user_thread.join();
+	}
+	else if (controlled)
+	{
+		control_message_t message;
+		control.send(control_message_t("stop"));
+		while ((control.recv(message) == 0) && !message.is("result"));
+
+		if (message.is("result"))
 		{
-			printf("packet %d send failed! (Error Code: %d) \n", local_pack_cnt - 1, ret);
-			keep_on = false;
-			break;
+			measured_role.report_peer(message, result);
+
+			// like in both mode, a stream is measured by what arrived
+			if (measured_role.mode() == speed_test_config_t::test_mode_t::tx)
+			{
+				result.ms = message.get_int("ms");
+				result.packets = (uint64_t)message.get_int("packets");
+				result.bytes = (uint64_t)message.get_int("bytes");
+				result.errors = (uint64_t)message.get_int("errors");
+				result.lost = (uint64_t)message.get_int("lost");
+				result.missing = (uint64_t)message.get_int("missing");
+				result.cpu.user_ns = (uint64_t)message.get_int("cpu_user_ns");
+				result.cpu.sys_ns = (uint64_t)message.get_int("cpu_sys_ns");
+			}
 		}
+		else
+			printf("rx peer closed the control channel without its results... \n");
+	}
+
+	// the rx clock starts with the first packet, so its window ends a little later; tx keeps its sockets open
+	// past that point and a streaming rx peer closes first, a ping-pong rx waits for the tx to close instead;
+	// either way no side sees a link fail inside its window
+	if (timed && measured && (roles.size() == 1) && (measured_role.mode() != speed_test_config_t::test_mode_t::rx) && !controlled)
+		std::this_thread::sleep_for(milliseconds(TIMED_TX_LINGER_MS));
+
+	// every role stops before any socket goes down, so no link of the other role reports its peer closing
+	stop(roles);
+
+	For(role_id, roles.size())
+		roles[role_id]->shutdown();
+
+	For(role_id, roles.size())
+		roles[role_id]->report_stop_skew();
 
-		pack_cnt.fetch_add(1ll);
+	For(role_id, roles.size())
+		roles[role_id]->close();
+
+	if (controlled && !control_rx)
+		control.close();
+
+	return 0;
+}
+
+static inline bool running(const std::vector<std::unique_ptr<test_role_t>> & roles)
+{
+	For(role_id, roles.size())
+	{
+		if (!roles[role_id]->running())
+			return false;
 	}
 
-	delete[] packet;
+	return true;
 }
 
-static void rx_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
+static inline void stop(std::vector<std::unique_ptr<test_role_t>> & roles)
 {
-	(void)link_id;
-	char * packet = new char[8 + config.pack_len() - config.pack_len() % 8];
-	int32_t local_pack_cnt{ 0 };
-	int ret{ 0 };
+	For(role_id, roles.size())
+		roles[role_id]->stop();
+}
 
-	if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
-	{
-		do {
-			ret = link.create(ip_protocol_t::udp, config.server(server_id).ip_address(),
-				(uint16_t)(config.server(server_id).port() + port_id));
+test_role_t::test_role_t(const speed_test_config_t & _config, const speed_test_config_t::test_mode_t _mode, const bool _tagged) :
+	config{ _config }, tagged{ _tagged }
+{
+	config.mode(_mode);
+}
 
-			if (ret == 0)
-				break;
+test_role_t::~test_role_t()
+{
+	close();
+}
 
-			printf("%lluth port of %lluth client of %lluth server: 'create' method failed! (Error Code: %d) \n",
-				port_id + 1, client_id + 1, server_id + 1, ret);
+const char * test_role_t::name() const
+{
+	switch (config.mode())
+	{
+	case speed_test_config_t::test_mode_t::tx:
+		return "tx";
+	case speed_test_config_t::test_mode_t::rx:
+		return "rx";
+	case speed_test_config_t::test_mode_t::ping_pong:
+		return "ping-pong";
+	default:
+		return "both";
+	}
+}
+
+void test_role_t::setup(const std::size_t _placement_offset)
+{
+	n_connection = 0;
+	keep_on = true;
+	echoed = false;
+	window_closed = false;
+	connection_cnt = 0;
+	placement_offset = _placement_offset;
+	listening.reset();
+	ready.reset();
+	start.reset();
+	stopped.reset();
 
-			std::this_thread::sleep_for(750ms);
-		} while (true);
+	For(srv_id, config.server_count())
+	{
+		For(cli_id, config.server(srv_id).client_count())
+			n_connection += config.server(srv_id).client(cli_id).port_count();
 	}
 
-	if (ret == 0)
+	threads = new std::thread[n_connection];
+	connection = new socket_t[n_connection];
+	stats.resize(n_connection);
+
+	report_state = report_state_t();
+	report_state.last_sample.resize(n_connection);
+	report_state.last_thread_ns.resize(n_connection);
+	report_state.last_thread_bytes.resize(n_connection);
+
+	if (config.mode() == speed_test_config_t::test_mode_t::ping_pong)
+		rtt_hist = new histogram_t[n_connection];
+	else if ((config.mode() == speed_test_config_t::test_mode_t::rx) && (config.protocol() == speed_test_config_t::ip_protocol_t::udp))
+		owd_hist = new histogram_t[n_connection];
+	else if (use_churn() && (config.mode() == speed_test_config_t::test_mode_t::tx))
+		connect_hist = new histogram_t[n_connection];
+
+	if (records.is_open() && (latency_hist() != nullptr))
+		report_state.last_link_latency.resize(n_connection);
+
+	if (config.churn() && !use_churn())
+		printf("connection churn needs TCP tx/rx links, streaming instead... \n");
+
+	if (use_duplex())
 	{
-		if (connection_cnt.fetch_add(1) + 1 == n_connection)
-			ready.set();
+		reverse_threads = new std::thread[n_connection];
+		reverse_started = new std::atomic<bool>[n_connection]();
+		reverse_stats.resize(n_connection);
+		report_state.last_reverse_sample.resize(n_connection);
+		report_state.last_reverse_thread_ns.resize(n_connection);
+	}
+	else if (config.duplex())
+		printf("full duplex needs TCP tx/rx links on the thread-per-link syscall engine, running half duplex... \n");
+
+	// the link threads prefault their own slab once pinned, nothing is allocated while they run
+	int ret = buffer_pool.create(n_connection * (reverse_threads != nullptr ? 2 : 1), buffer_slab_size(), config.huge_pages());
+	if (ret != 0)
+		throw new std::runtime_error("Packet Buffer Allocation Failed!");
 
-		start.wait();
+	if (config.huge_pages() && (buffer_pool.backing() != buffer_pool_t::backing_t::huge_pages))
+		printf("no huge pages reserved (vm.nr_hugepages), packet buffers use %s... \n", buffer_pool_t::backing_name(buffer_pool.backing()));
+
+	if ((config.mode() == speed_test_config_t::test_mode_t::rx) &&
+		(config.rx_engine() == speed_test_config_t::rx_engine_t::epoll) && !poller_t::is_supported())
+		printf("epoll rx engine is not supported on this platform, using thread per link... \n");
+
+	if ((config.io_backend() == speed_test_config_t::io_backend_t::io_uring) && !uring_t::is_supported())
+		printf("io_uring backend is not supported on this platform, using syscalls... \n");
+	else if (use_uring() && rx_use_poller() && (config.mode() == speed_test_config_t::test_mode_t::rx))
+		printf("io_uring backend is not used by the epoll rx engine... \n");
+
+	if ((config.zerocopy() != speed_test_config_t::zerocopy_t::off) && (config.mode() == speed_test_config_t::test_mode_t::tx))
+	{
+		if (config.protocol() != speed_test_config_t::ip_protocol_t::tcp)
+			printf("zero copy tx is only used for TCP... \n");
+		else if (!socket_t::is_zerocopy_supported())
+			printf("zero copy tx is not supported on this platform, copying... \n");
+		else if (use_uring())
+			printf("zero copy tx is not used by the io_uring backend... \n");
 	}
 
-	while (keep_on)
+	if (config.pacing().enabled() && (config.mode() == speed_test_config_t::test_mode_t::tx))
 	{
-		ret = link.recv(packet, (int)config.pack_len());
-		if (ret != 0)
+		if (use_churn())
+			printf("pacing is not used by connection churn... \n");
+		else
 		{
-			printf("%lluth server, %lluth client, %lluth port receive failed! (Error Code: %d) \n",
-				server_id + 1, client_id + 1, port_id + 1, ret);
-			keep_on = false;
-			break;
+			pacers = new pacer_t[n_connection];
+			pace_bytes_per_s = config.pacing().link_bytes_per_s(config.pack_len(), n_connection);
 		}
+	}
+	else if (config.pacing().enabled() && (config.mode() == speed_test_config_t::test_mode_t::ping_pong))
+		printf("pacing is not used by ping-pong, outstanding requests bound its rate... \n");
 
-		pack_cnt.fetch_add(1ll);
+	placement_init();
+}
 
-		if (config.protocol() == speed_test_config_t::ip_protocol_t::tcp)
-		{
-			if (*(int32_t*)packet != (local_pack_cnt > (1 << 30) ? local_pack_cnt = 0 : local_pack_cnt)++)
-			{
-				printf("%lluth server %dth packet corrupted! \n", server_id + 1, local_pack_cnt - 1);
-				keep_on = false;
-				break;
-			}
-		}
+void test_role_t::launch()
+{
+	if ((config.mode() == speed_test_config_t::test_mode_t::tx) || (config.mode() == speed_test_config_t::test_mode_t::ping_pong))
+		tx_start();
+	else if (config.mode() == speed_test_config_t::test_mode_t::rx)
+	{
+		if (use_churn())
+			rx_churn_start();
+		else if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
+			rx_udp_start();
+		else
+			rx_tcp_start();
 	}
+	else
+		throw new std::invalid_argument("Invalid Test Mode!");
+
+	listening.set();
+}
+
+void test_role_t::wait_ready()
+{
+	if (!keep_on)
+		return;
+
+	ready.wait();
 
-	delete[] packet;
+	if (tagged)
+		printf("%s: ", name());
+
+	// churn connections live too short to show their options
+	printf(use_churn() ? "churn links ready... \n" : "connection established... \n");
+	report_placement();
+
+	if (!use_churn())
+		report_socket_options();
+
+	if (pacers != nullptr)
+	{
+		printf("pacing %3.3lf Mbps (%.0lf pps) per link in %s... \n", pace_bytes_per_s * 8. / 1e6, pace_bytes_per_s / config.pack_len(),
+			config.pacing().engine() == pacing_config_t::engine_t::kernel ? "the kernel" : "user space");
+	}
+}
+
+void test_role_t::begin()
+{
+	// the links sleep at the start barrier until now and spin from here to the open, whatever ran before
+	// (reports, other roles, the control channel, the clock calibration) did not cost them a busy core
+	start.arm();
+
+	cpu_usage::process_time(run_cpu_time);
+	report_state.last_process_time = run_cpu_time;
+
+	start.open();
+}
+
+// wakes every thread blocked on a link of this role
+void test_role_t::shutdown()
+{
+	For(con_id, n_connection)
+		connection[con_id].shutdown();
+
+	if (churn_servers != nullptr)
+	{
+		For(con_id, n_connection)
+			churn_servers[con_id].shutdown();
+	}
+}
+
+void test_role_t::close()
+{
+	For(con_id, n_connection)
+		connection[con_id].close();
+
+	For(con_id, n_connection)
+	{
+		if (threads[con_id].joinable())
+			threads[con_id].join();
+
+		std::thread * reverse{ reverse_thread(con_id) };
+		if ((reverse != nullptr) && reverse->joinable())
+			reverse->join();
+	}
+
+	DELETE_MULTI(threads);
+	DELETE_MULTI(reverse_threads);
+	DELETE_MULTI(reverse_started);
+	DELETE_MULTI(connection);
+	DELETE_MULTI(churn_servers);
+	DELETE_MULTI(rx_link);
+	DELETE_MULTI(poller);
+	DELETE_MULTI(rtt_hist);
+	DELETE_MULTI(owd_hist);
+	DELETE_MULTI(connect_hist);
+	DELETE_MULTI(pacers);
+	buffer_pool.close();
+
+	pace_bytes_per_s = 0.;
+
+	n_connection = 0;
+	n_poller = 0;
+}
+
+void test_role_t::report_summary(const long long ms)
+{
+	if (tagged)
+		printf("%s: \n", name());
+
+	if (pacers != nullptr)
+	{
+		uint64_t bytes{ 0 };
+		For(con_id, n_connection)
+			bytes += stats[con_id].sample().bytes;
+
+		report_pacing("overall ", bytes, ms, n_connection);
+	}
+
+	report_cpu_overall(ms);
+
+	report_overall("RTT", rtt_hist);
+	report_overall("one-way delay", owd_hist);
+	report_overall("connect latency", connect_hist);
+}
+
+// totals of every link since the run began, sent to the tx peer as "link.<n>" fields
+void test_role_t::add_link_results(control_message_t & message)
+{
+	message.set("link_count", (long long)n_connection);
+
+	For(con_id, n_connection)
+	{
+		const link_sample_t sample{ stats[con_id].sample() };
+
+		message.set("link." + std::to_string(con_id), std::to_string(stats[con_id].server_id) + "," + std::to_string(stats[con_id].client_id) +
+			"," + std::to_string(stats[con_id].port_id) + "," + std::to_string(sample.packets) + "," + std::to_string(sample.bytes) +
+			"," + std::to_string(sample.errors) + "," + std::to_string(sample.lost) + "," + std::to_string(sample.seq_gaps));
+	}
+}
+
+// what was sent next to what the rx peer received; tcp rx links of one client are told apart by accept order only
+void test_role_t::report_peer(const control_message_t & peer, const run_result_t & window)
+{
+	std::map<std::vector<int>, std::vector<uint64_t>> peer_links;
+	uint64_t peer_packets{ 0 }, peer_lost{ 0 }, packets{ 0 };
+
+	For(con_id, (std::size_t)MAX(peer.get_int("link_count"), 0ll))
+	{
+		std::vector<uint64_t> fields;
+		std::stringstream stream(peer.get("link." + std::to_string(con_id)));
+		std::string item;
+
+		while (std::getline(stream, item, ','))
+			fields.push_back(strtoull(item.c_str(), nullptr, 10));
+
+		if (fields.size() < 8)
+			continue;
+
+		peer_links[{ (int)fields[0], (int)fields[1], (int)fields[2] }] = { fields[3], fields[4], fields[5], fields[6], fields[7] };
+		peer_packets += fields[3];
+		peer_lost += fields[6];
+	}
+
+	printf("combined with rx peer: \n");
+
+	For(con_id, n_connection)
+	{
+		const link_sample_t sample{ stats[con_id].sample() };
+		packets += sample.packets;
+
+		const auto link = peer_links.find({ (int)stats[con_id].server_id, (int)stats[con_id].client_id, (int)stats[con_id].port_id });
+		if (!config.per_link_report() || (link == peer_links.end()))
+			continue;
+
+		printf("  link %llu (server %llu, client %llu, port %llu): %llu packets sent, %llu received, %llu lost, %llu rx errors, %llu gaps \n",
+			(unsigned long long)con_id + 1, (unsigned long long)stats[con_id].server_id + 1, (unsigned long long)stats[con_id].client_id + 1,
+			(unsigned long long)stats[con_id].port_id + 1,
+			(unsigned long long)sample.packets, (unsigned long long)link->second[0], (unsigned long long)link->second[3],
+			(unsigned long long)link->second[2], (unsigned long long)link->second[4]);
+	}
+
+	const long long peer_ms{ peer.get_int("ms") };
+	const uint64_t peer_bytes{ (uint64_t)peer.get_int("bytes") };
+
+	printf("tx %3.3lf Mbps over %lld ms, rx %3.3lf Mbps over %lld ms, %llu rx errors \n",
+		window.ms > 0 ? (window.bytes * 8.) / (window.ms * 1000.) : 0., window.ms,
+		peer_ms > 0 ? (peer_bytes * 8.) / (peer_ms * 1000.) : 0., peer_ms, (unsigned long long)peer.get_int("errors"));
+
+	// the run totals include the packets still in flight when either side stopped counting
+	printf("%llu of %llu packets received (%.3lf%% missing), %llu lost by sequence \n\n", (unsigned long long)peer_packets,
+		(unsigned long long)packets, packets > peer_packets ? (packets - peer_packets) * 100. / packets : 0., (unsigned long long)peer_lost);
+}
+
+// every packet starts with its header, an udp one also has to fit into a datagram
+static bool valid_pack_len(const speed_test_config_t::ip_protocol_t protocol, const long long pack_len)
+{
+	return (pack_len >= (long long)sizeof(packet_header_t)) &&
+		((protocol != speed_test_config_t::ip_protocol_t::udp) || (pack_len <= MAX_UDP_PACKET_SIZE));
+}
+
+// the packet lengths of the test, sweep or search about to run, each with the protocol it is sent with
+static bool validate_config()
+{
+	const sweep_config_t & sweep{ config.sweep() };
+	const search_config_t & search{ config.search() };
+
+	std::vector<int> protocols{ (int)config.protocol() }, pack_lens{ config.pack_len() };
+
+	if (sweep.enabled())
+	{
+		if (!sweep.lists_valid())
+		{
+			printf("sweep lists must be comma separated integers! \n");
+			return false;
+		}
+
+		if (!sweep.protocols().empty())
+			protocols = sweep.protocols();
+
+		if (!sweep.pack_lens().empty())
+			pack_lens = sweep.pack_lens();
+	}
+	else if (search.enabled())
+	{
+		if (!search.lists_valid())
+		{
+			printf("rate search packet lengths must be comma separated integers! \n");
+			return false;
+		}
+
+		protocols = { (int)speed_test_config_t::ip_protocol_t::udp };
+		if (!search.pack_lens().empty())
+			pack_lens = search.pack_lens();
+	}
+
+	for (const int protocol : protocols)
+	{
+		const bool udp{ protocol == (int)speed_test_config_t::ip_protocol_t::udp };
+
+		for (const int pack_len : pack_lens)
+		{
+			if (!valid_pack_len((speed_test_config_t::ip_protocol_t)protocol, pack_len))
+			{
+				if (udp)
+					printf("packet length %d is not valid for udp, it takes %d to %d bytes! \n", pack_len, (int)sizeof(packet_header_t), MAX_UDP_PACKET_SIZE);
+				else
+					printf("packet length %d is not valid for tcp, it takes at least %d bytes! \n", pack_len, (int)sizeof(packet_header_t));
+
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void run_sweep()
+{
+	const sweep_config_t & sweep{ config.sweep() };
+	const std::vector<int> configured{ -1 };
+
+	std::vector<int> protocols{ sweep.protocols() };
+	std::vector<int> pack_lens{ sweep.pack_lens() };
+	std::vector<int> port_counts{ sweep.port_counts() };
+	std::vector<int> socket_buffers{ sweep.socket_buffers() };
+	std::vector<int> tcp_no_delays{ sweep.tcp_no_delays() };
+
+	for (std::vector<int> * list : { &protocols, &pack_lens, &port_counts, &socket_buffers, &tcp_no_delays })
+	{
+		if (list->empty())
+			*list = configured;
+	}
+
+	result_matrix_t matrix;
+	if (!matrix.open(sweep.result_file()))
+	{
+		printf("sweep result file '%s' can not be written! \n", sweep.result_file().c_str());
+		return;
+	}
+
+	const char * mode{ config.mode() == speed_test_config_t::test_mode_t::tx ? "tx" :
+		config.mode() == speed_test_config_t::test_mode_t::rx ? "rx" :
+		config.mode() == speed_test_config_t::test_mode_t::ping_pong ? "ping-pong" : "both" };
+	const std::size_t n_cell{ protocols.size() * pack_lens.size() * port_counts.size() * socket_buffers.size() * tcp_no_delays.size() };
+	std::size_t cell_id{ 0 };
+
+	run_plan_t plan;
+	plan.duration_ms = MAX(sweep.cell_duration(), 1);
+	plan.warmup_ms = MAX(sweep.warmup(), 0);
+	plan.interval_ms = MAX(config.run().report_interval(), 1);
+
+	// both peers walk the same matrix in the same order; tx retries its connects until rx listens for the cell
+	for (const int protocol : protocols)
+	for (const int pack_len : pack_lens)
+	for (const int port_count : port_counts)
+	for (const int socket_buffer : socket_buffers)
+	for (const int tcp_no_delay : tcp_no_delays)
+	{
+		sweep_cell_t cell;
+		cell.protocol = protocol;
+		cell.pack_len = pack_len;
+		cell.port_count = port_count;
+		cell.socket_buffer = socket_buffer;
+		cell.tcp_no_delay = tcp_no_delay;
+
+		if (protocol >= 0)
+			config.protocol((speed_test_config_t::ip_protocol_t)protocol);
+		if (pack_len >= 0)
+			config.pack_len(pack_len);
+
+		For(srv_id, config.server_count())
+		{
+			server_config_t & server{ config.server(srv_id) };
+			socket_options_t options{ server.socket_options() };
+
+			if (socket_buffer >= 0)
+				options.send_buffer = options.recv_buffer = socket_buffer;
+			if (tcp_no_delay >= 0)
+				options.tcp_no_delay = tcp_no_delay != 0;
+
+			server.socket_options(options);
+
+			For(cli_id, server.client_count())
+			{
+				client_config_t & client{ server.client(cli_id) };
+				options = client.socket_options();
+
+				if (port_count >= 0)
+					client.port_count((std::size_t)port_count);
+				if (socket_buffer >= 0)
+					options.send_buffer = options.recv_buffer = socket_buffer;
+				if (tcp_no_delay >= 0)
+					options.tcp_no_delay = tcp_no_delay != 0;
+
+				client.socket_options(options);
+			}
+		}
+
+		printf("\nsweep cell %llu/%llu: protocol %d, packet length %d, port count %d, socket buffer %d, tcp no delay %d \n",
+			(unsigned long long)(++cell_id), (unsigned long long)n_cell, protocol, pack_len, port_count, socket_buffer, tcp_no_delay);
+
+		if (!valid_pack_len(config.protocol(), config.pack_len()))
+		{
+			printf("packet length %d is not valid for this protocol, cell skipped... \n", config.pack_len());
+			continue;
+		}
+
+		// in both mode, each cell listens before it connects, and a controlled rx answers once it listens again
+		if ((cell_id > 1) && (config.mode() != speed_test_config_t::test_mode_t::rx) &&
+			(config.mode() != speed_test_config_t::test_mode_t::both) && !config.control())
+			std::this_thread::sleep_for(milliseconds(SWEEP_CELL_GAP_MS));
+
+		run_result_t result;
+		run_test(plan, result);
+		matrix.add(mode, cell, result);
+	}
+
+	matrix.close();
+	printf("\nsweep results written to %s.csv and %s.json \n", sweep.result_file().c_str(), sweep.result_file().c_str());
+}
+
+static void run_search()
+{
+	const search_config_t & search{ config.search() };
+
+	// a tx peer learns the loss of its rx peer over the control channel
+	if ((config.mode() != speed_test_config_t::test_mode_t::both) &&
+		((config.mode() != speed_test_config_t::test_mode_t::tx) || !config.control()))
+	{
+		printf("rate search needs both mode or tx with a control port, as the receiver's loss decides every trial... \n");
+		return;
+	}
+
+	if (config.protocol() != speed_test_config_t::ip_protocol_t::udp)
+	{
+		printf("rate search needs UDP, TCP retransmits what is lost... \n");
+		return;
+	}
+
+	std::vector<int> pack_lens{ search.pack_lens() };
+	if (pack_lens.empty())
+		pack_lens.push_back(config.pack_len());
+
+	search_table_t table;
+	if (!table.open(search.result_file()))
+	{
+		printf("rate search result file '%s' can not be written! \n", search.result_file().c_str());
+		return;
+	}
+
+	const double min_rate{ MAX(search.min_rate(), 0.001) };
+	const double max_rate{ MAX(search.max_rate(), min_rate) };
+	const double resolution{ MAX(search.resolution(), 0.01) };
+
+	run_plan_t plan;
+	plan.duration_ms = MAX(search.trial_duration(), 1);
+	plan.warmup_ms = MAX(search.warmup(), 0);
+	plan.interval_ms = MAX(config.run().report_interval(), 1);
+
+	config.pacing().unit(pacing_config_t::unit_t::mbps_total);
+
+	for (const int pack_len : pack_lens)
+	{
+		config.pack_len(pack_len);
+
+		if (!valid_pack_len(speed_test_config_t::ip_protocol_t::udp, pack_len))
+		{
+			printf("packet length %d is not valid for UDP, skipped... \n", pack_len);
+			continue;
+		}
+
+		double passed_rate{ 0. };
+		int trials{ 0 };
+		run_result_t result, passed;
+
+		// a receiver that keeps up with the max rate needs no search
+		if (search_trial(plan, max_rate, trials, result))
+		{
+			passed_rate = max_rate;
+			passed = result;
+		}
+		else
+		{
+			double low{ min_rate }, high{ max_rate };
+			while (high - low > high * resolution / 100.)
+			{
+				const double rate{ (low + high) / 2. };
+
+				if (search_trial(plan, rate, trials, result))
+				{
+					low = passed_rate = rate;
+					passed = result;
+				}
+				else
+					high = rate;
+			}
+
+			// the min rate itself is only tried once every rate above it failed
+			if ((passed_rate == 0.) && search_trial(plan, min_rate, trials, result))
+			{
+				passed_rate = min_rate;
+				passed = result;
+			}
+		}
+
+		if (passed_rate > 0.)
+		{
+			const double ms{ passed.ms > 0 ? (double)passed.ms : 1. };
+
+			printf("\nrate search, packet length %d: %.3lf Mbps offered, %.3lf Mbps / %.0lf pps received, %llu lost after %d trials \n\n",
+				pack_len, passed_rate, (passed.bytes * 8.) / (ms * 1000.), (passed.packets * 1000.) / ms,
+				(unsigned long long)passed.lost, trials);
+		}
+		else
+			printf("\nrate search, packet length %d: no rate down to %.3lf Mbps passed after %d trials \n\n", pack_len, min_rate, trials);
+
+		table.add(pack_len, passed_rate, trials, passed);
+	}
+
+	table.close();
+	printf("rate search results written to %s.csv and %s.json \n", search.result_file().c_str(), search.result_file().c_str());
+}
+
+// one timed run at a paced total rate, judged by what the rx role (or rx peer) lost
+static bool search_trial(const run_plan_t & plan, const double rate, int & trials, run_result_t & result)
+{
+	config.pacing().rate(rate);
+
+	printf("\nrate search trial %d: packet length %d, %.3lf Mbps offered \n", ++trials, config.pack_len(), rate);
+
+	run_test(plan, result);
+
+	// the receive windows only count a packet lost once it slides out of them, flush what they still miss
+	result.lost += result.missing;
+	result.missing = 0;
+
+	const double loss{ result.packets + result.lost > 0 ? result.lost * 100. / (result.packets + result.lost) : 100. };
+	const bool passed{ (result.packets > 0) && (result.errors == 0) && (loss <= config.search().max_loss()) };
+
+	printf("rate search trial %d %s: %.3lf%% lost, %llu errors \n", trials, passed ? "passed" : "failed", loss,
+		(unsigned long long)result.errors);
+
+	return passed;
+}
+
+// serves one test per tx peer connecting to the control port, each with the parameters that peer asked for
+static void run_control_server()
+{
+	tcp_server_t listener;
+
+	int ret = listener.create(config.server(0).ip_address(), (uint16_t)config.control_port());
+	if (ret == 0)
+		ret = listener.listen(1);
+
+	if (ret != 0)
+	{
+		printf("control port %d can not listen on %s! (Error Code: %d) \n", config.control_port(), config.server(0).ip_address().c_str(), ret);
+		return;
+	}
+
+	const speed_test_config_t configured{ config };
+
+	while (true)
+	{
+		printf("\nwaiting for a tx peer on control port %d... \n", config.control_port());
+
+		ret = control.accept(listener);
+		if (ret != 0)
+		{
+			printf("control port 'accept' method failed! (Error Code: %d) \n", ret);
+			break;
+		}
+
+		control_message_t setup;
+		std::string reason;
+
+		config = configured;
+		if ((control.recv(setup) != 0) || !setup.is("setup"))
+			printf("tx peer sent no test setup... \n");
+		else if (!control_apply(setup, reason))
+		{
+			printf("test of tx peer %s rejected: %s \n", setup.get("peer").c_str(), reason.c_str());
+
+			control_message_t reply("reject");
+			reply.set("reason", reason);
+			control.send(reply);
+		}
+		else
+		{
+			run_plan_t plan;
+			plan.duration_ms = MAX(setup.get_int("duration_ms"), 0ll);
+			plan.warmup_ms = MAX(setup.get_int("warmup_ms"), 0ll);
+			plan.interval_ms = MAX(config.run().report_interval(), 1);
+
+			printf("test of tx peer %s: protocol %s, packet length %d, %llu links, %lld ms \n", setup.get("peer").c_str(),
+				config.protocol() == speed_test_config_t::ip_protocol_t::tcp ? "tcp" : "udp", config.pack_len(),
+				(unsigned long long)setup.get_int("links"), plan.duration_ms);
+
+			run_result_t result;
+			run_test(plan, result);
+		}
+
+		control.close();
+	}
+
+	config = configured;
+}
+
+// tx side of a test over the control channel; the rx peer is listening on every link once this returns 0
+static int control_connect(const run_plan_t & plan)
+{
+	const uint16_t control_port{ (uint16_t)config.control_port() };
+	const std::string & control_ip{ config.server(0).ip_address() };
+	const auto give_up_time = steady_clock::now() + milliseconds(CONTROL_CONNECT_MS);
+
+	int ret;
+	while (((ret = control.connect(control_ip, control_port)) != 0) && (steady_clock::now() < give_up_time))
+		std::this_thread::sleep_for(750ms);
+
+	if (ret != 0)
+	{
+		printf("control channel to (%s %d) failed! (Error Code: %d) \n", control_ip.c_str(), control_port, ret);
+		return ret;
+	}
+
+	std::string clients, ports;
+	std::size_t link_count{ 0 };
+
+	For(srv_id, config.server_count())
+	{
+		clients += (srv_id > 0 ? "," : "") + std::to_string(config.server(srv_id).client_count());
+
+		For(cli_id, config.server(srv_id).client_count())
+		{
+			ports += (ports.empty() ? "" : ",") + std::to_string(config.server(srv_id).client(cli_id).port_count());
+			link_count += config.server(srv_id).client(cli_id).port_count();
+		}
+	}
+
+	control_message_t setup("setup");
+	setup.set("peer", config.server(0).client(0).ip_address());
+	setup.set("protocol", (long long)config.protocol());
+	setup.set("pack_len", (long long)config.pack_len());
+	setup.set("response_len", (long long)config.response_len());
+	setup.set("duplex", (long long)config.duplex());
+	setup.set("churn", (long long)config.churn());
+	setup.set("churn_bytes", (long long)config.churn_bytes());
+	setup.set("duration_ms", plan.duration_ms);
+	setup.set("warmup_ms", plan.warmup_ms);
+	setup.set("clients", clients);
+	setup.set("ports", ports);
+	setup.set("links", (long long)link_count);
+
+	control_message_t reply;
+	ret = control.send(setup);
+	if (ret == 0)
+		ret = control.recv(reply);
+
+	if (ret != 0)
+		printf("control channel to (%s %d) failed! (Error Code: %d) \n", control_ip.c_str(), control_port, ret);
+	else if (!reply.is("ready"))
+	{
+		printf("rx peer rejected the test: %s \n", reply.get("reason", reply.verb()).c_str());
+		ret = -1;
+	}
+
+	if (ret != 0)
+		control.close();
+
+	return ret;
+}
+
+// rx takes the stream parameters of the tx peer; both configs must list the same servers and clients, and
+// every value comes off the network, so nothing is applied before all of them were checked
+static bool control_apply(const control_message_t & setup, std::string & reason)
+{
+	std::vector<int> clients, ports;
+	std::size_t client_count{ 0 };
+
+	if (!sweep_config_t::parse_list(setup.get("clients"), clients) || !sweep_config_t::parse_list(setup.get("ports"), ports))
+	{
+		reason = "malformed client or port counts";
+		return false;
+	}
+
+	if (clients.size() != config.server_count())
+	{
+		reason = "tx has " + std::to_string(clients.size()) + " servers, rx " + std::to_string(config.server_count());
+		return false;
+	}
+
+	For(srv_id, config.server_count())
+	{
+		if (clients[srv_id] != (int)config.server(srv_id).client_count())
+		{
+			reason = "tx has " + std::to_string(clients[srv_id]) + " clients on server " + std::to_string(srv_id + 1) +
+				", rx " + std::to_string(config.server(srv_id).client_count());
+			return false;
+		}
+
+		client_count += clients[srv_id];
+	}
+
+	if (ports.size() != client_count)
+	{
+		reason = "malformed port counts";
+		return false;
+	}
+
+	for (const int port_count : ports)
+	{
+		if ((port_count < 0) || (port_count > CONTROL_MAX_PORT_COUNT))
+		{
+			reason = "port count " + std::to_string(port_count) + " is out of range";
+			return false;
+		}
+	}
+
+	const long long protocol{ setup.get_int("protocol", -1) };
+	if ((protocol != (long long)speed_test_config_t::ip_protocol_t::tcp) && (protocol != (long long)speed_test_config_t::ip_protocol_t::udp))
+	{
+		reason = "unknown protocol " + setup.get("protocol");
+		return false;
+	}
+
+	const bool udp{ protocol == (long long)speed_test_config_t::ip_protocol_t::udp };
+	const long long max_len{ udp ? MAX_UDP_PACKET_SIZE : PACKET_MAX_RESPONSE_LEN };
+	const long long pack_len{ setup.get_int("pack_len", -1) };
+	const long long response_len{ setup.get_int("response_len", -1) };
+	const long long churn_bytes{ setup.get_int("churn_bytes", -1) };
+
+	if (!valid_pack_len((speed_test_config_t::ip_protocol_t)protocol, pack_len) || (pack_len > max_len))
+	{
+		reason = "packet length " + setup.get("pack_len") + " is not valid for this protocol";
+		return false;
+	}
+
+	if ((response_len < 0) || (response_len > max_len))
+	{
+		reason = "response length " + setup.get("response_len") + " is out of range";
+		return false;
+	}
+
+	if ((churn_bytes < 0) || (churn_bytes > PACKET_MAX_RESPONSE_LEN))
+	{
+		reason = "churn bytes " + setup.get("churn_bytes") + " is out of range";
+		return false;
+	}
+
+	config.protocol((speed_test_config_t::ip_protocol_t)protocol);
+	config.pack_len((int)pack_len);
+	config.response_len((int)response_len);
+	config.duplex(setup.get_int("duplex") != 0);
+	config.churn(setup.get_int("churn") != 0);
+	config.churn_bytes((int)churn_bytes);
+
+	std::size_t port_id{ 0 };
+	For(srv_id, config.server_count())
+	{
+		For(cli_id, config.server(srv_id).client_count())
+		{
+			config.server(srv_id).client(cli_id).port_count((std::size_t)ports[port_id]);
+			++port_id;
+		}
+	}
+
+	return true;
+}
+
+void test_role_t::take_snapshot(run_result_t & snapshot, const long long ms)
+{
+	snapshot = run_result_t();
+	snapshot.ms = ms;
+
+	For(con_id, n_connection)
+	{
+		const link_sample_t sample{ stats[con_id].sample() };
+
+		snapshot.packets += sample.packets;
+		snapshot.bytes += sample.bytes;
+		snapshot.errors += sample.errors;
+		snapshot.lost += sample.lost;
+		snapshot.missing += sample.missing;
+	}
+
+	cpu_usage::process_time(snapshot.cpu);
+
+	const histogram_t * hist{ latency_hist() };
+	if (hist != nullptr)
+	{
+		histogram_sample_t sample;
+		For(con_id, n_connection)
+		{
+			hist[con_id].sample(sample);
+			snapshot.latency += sample;
+		}
+	}
+}
+
+uint64_t test_role_t::total_bytes()
+{
+	uint64_t bytes{ 0 };
+	For(con_id, n_connection)
+		bytes += stats[con_id].bytes.load(std::memory_order_relaxed);
+
+	return bytes;
+}
+
+void test_role_t::report(const long long ms)
+{
+	if (tagged)
+		printf("%s: \n", name());
+
+	uint64_t & syscall_cnt{ report_state.syscall_cnt };
+	std::vector<link_sample_t> & last_sample{ report_state.last_sample };
+	histogram_sample_t & last_rtt{ report_state.last_rtt };
+	histogram_sample_t & last_owd{ report_state.last_owd };
+	cpu_time_t & last_process_time{ report_state.last_process_time };
+	std::vector<uint64_t> & last_thread_ns{ report_state.last_thread_ns };
+	std::vector<uint64_t> & last_thread_bytes{ report_state.last_thread_bytes };
+
+	std::vector<link_sample_t> & last_reverse_sample{ report_state.last_reverse_sample };
+	std::vector<uint64_t> & last_reverse_thread_ns{ report_state.last_reverse_thread_ns };
+
+	const uint64_t last_syscall_cnt{ syscall_cnt };
+	link_sample_t total, zerocopy_total, reverse_total;
+	// a ping-pong packet is one request and its response, a churn packet is one connection
+	const char * rate_unit{ rtt_hist != nullptr ? "transactions/s" : use_churn() ? "connections/s" : "pps" };
+	std::size_t zerocopy_links{ 0 };
+
+	const histogram_t * hist{ latency_hist() };
+	std::vector<histogram_sample_t> & last_link_latency{ report_state.last_link_latency };
+	histogram_sample_t total_latency, link_latency, sample_latency;
+
+	report_state.elapsed_ms += ms;
+
+	if (!report_state.start_reported)
+	{
+		report_start_skew();
+		report_state.start_reported = true;
+	}
+
+	syscall_cnt = 0;
+	For(con_id, n_connection)
+	{
+		link_sample_t sample{ stats[con_id].sample() };
+		sample.reorder_max = stats[con_id].take_reorder_max();
+
+		const link_sample_t delta{ sample - last_sample[con_id] };
+
+		last_sample[con_id] = sample;
+		total += delta;
+		syscall_cnt += connection[con_id].syscall_count();
+
+		link_sample_t reverse_delta;
+		if (reverse_threads != nullptr)
+		{
+			const link_sample_t reverse_sample{ reverse_stats[con_id].sample() };
+
+			reverse_delta = reverse_sample - last_reverse_sample[con_id];
+			last_reverse_sample[con_id] = reverse_sample;
+			reverse_total += reverse_delta;
+		}
+
+		if (records.is_open())
+		{
+			if (!last_link_latency.empty())
+			{
+				hist[con_id].sample(sample_latency);
+				link_latency = sample_latency - last_link_latency[con_id];
+				last_link_latency[con_id] = sample_latency;
+				total_latency += link_latency;
+			}
+
+			record_interval(con_id + 1, delta, ms, last_link_latency.empty() ? nullptr : &link_latency);
+
+			if (reverse_threads != nullptr)
+				record_interval(con_id + 1, reverse_delta, ms, nullptr, true);
+		}
+
+		if (stats[con_id].zerocopy)
+		{
+			zerocopy_total += delta;
+			++zerocopy_links;
+		}
+
+		if (config.per_link_report())
+		{
+			printf("  link %llu (server %llu, client %llu, port %llu%s): %s%s%3.3lf Mbps, %.0lf %s, %llu errors, %llu gaps \n",
+				(unsigned long long)con_id + 1, (unsigned long long)stats[con_id].server_id + 1, (unsigned long long)stats[con_id].client_id + 1,
+				(unsigned long long)stats[con_id].port_id + 1,
+				stats[con_id].zerocopy ? ", zero copy" : "", reverse_threads != nullptr ? direction(false) : "",
+				reverse_threads != nullptr ? " " : "", (delta.bytes * 8.) / (ms * 1000.), (delta.packets * 1000.) / ms, rate_unit,
+				(unsigned long long)delta.errors, (unsigned long long)delta.seq_gaps);
+
+			report_pacing("    ", delta.bytes, ms, 1);
+
+			uint64_t thread_ns{ 0 };
+			if ((poller == nullptr) && threads[con_id].joinable() && (cpu_usage::thread_time(threads[con_id], thread_ns) == 0))
+			{
+				report_cpu("    ", thread_ns - last_thread_ns[con_id], delta.bytes, ms);
+				last_thread_ns[con_id] = thread_ns;
+			}
+
+			if (reverse_threads != nullptr)
+			{
+				printf("    %s %3.3lf Mbps, %.0lf pps, %llu errors, %llu gaps \n", direction(true),
+					(reverse_delta.bytes * 8.) / (ms * 1000.), (reverse_delta.packets * 1000.) / ms,
+					(unsigned long long)reverse_delta.errors, (unsigned long long)reverse_delta.seq_gaps);
+
+				std::thread * reverse{ reverse_thread(con_id) };
+				if ((reverse != nullptr) && reverse->joinable() && (cpu_usage::thread_time(*reverse, thread_ns) == 0))
+				{
+					report_cpu("    ", thread_ns - last_reverse_thread_ns[con_id], reverse_delta.bytes, ms);
+					last_reverse_thread_ns[con_id] = thread_ns;
+				}
+			}
+
+			if (owd_hist != nullptr)
+			{
+				printf("    %llu lost (%.3lf%%), %llu reordered (max distance %llu), %llu duplicated, %llu late, jitter %.1lf us \n",
+					(unsigned long long)delta.lost, loss_percent(delta), (unsigned long long)delta.reordered,
+					(unsigned long long)delta.reorder_max, (unsigned long long)delta.duplicated, (unsigned long long)delta.late,
+					delta.jitter_ns / 1000.);
+			}
+		}
+	}
+
+	// epoll workers serve link_id % n_poller, so their cost is normalized by the bytes of those links
+	if (config.per_link_report() && (poller != nullptr))
+	{
+		For(wrk_id, n_poller)
+		{
+			uint64_t thread_ns{ 0 }, worker_bytes{ 0 };
+			if (!threads[wrk_id].joinable() || (cpu_usage::thread_time(threads[wrk_id], thread_ns) != 0))
+				continue;
+
+			for (std::size_t con_id = wrk_id; con_id < n_connection; con_id += n_poller)
+				worker_bytes += last_sample[con_id].bytes;
+
+			printf("  rx worker %llu: ", (unsigned long long)wrk_id + 1);
+			report_cpu("", thread_ns - last_thread_ns[wrk_id], worker_bytes - last_thread_bytes[wrk_id], ms);
+			last_thread_ns[wrk_id] = thread_ns;
+			last_thread_bytes[wrk_id] = worker_bytes;
+		}
+	}
+
+	// a full duplex socket counts the syscalls of both directions
+	const uint64_t socket_packets{ total.packets + reverse_total.packets };
+
+	printf("%s%s%3.3lf Mbps, %.0lf %s, %.3lf syscall/packet, %llu errors, %llu gaps \n",
+		reverse_threads != nullptr ? direction(false) : "", reverse_threads != nullptr ? " " : "",
+		(total.bytes * 8.) / (ms * 1000.), (total.packets * 1000.) / ms, rate_unit,
+		socket_packets > 0 ? (syscall_cnt - last_syscall_cnt) / (double)socket_packets : 0.,
+		(unsigned long long)total.errors, (unsigned long long)total.seq_gaps);
+
+	if (reverse_threads != nullptr)
+	{
+		printf("%s %3.3lf Mbps, %.0lf pps, %llu errors, %llu gaps \n", direction(true),
+			(reverse_total.bytes * 8.) / (ms * 1000.), (reverse_total.packets * 1000.) / ms,
+			(unsigned long long)reverse_total.errors, (unsigned long long)reverse_total.seq_gaps);
+	}
+
+	report_pacing("", total.bytes, ms, n_connection);
+
+	cpu_time_t process_time;
+	const char * const process_prefix{ process_cpu_prefix() };
+	if ((process_prefix != nullptr) && (cpu_usage::process_time(process_time) == 0))
+	{
+		const cpu_time_t cpu_delta{ process_time - last_process_time };
+
+		printf("%scpu user %.3lf s, sys %.3lf s, ", process_prefix, cpu_delta.user_ns / 1e9, cpu_delta.sys_ns / 1e9);
+		report_cpu("", cpu_delta.total_ns(), total.bytes + reverse_total.bytes, ms);
+		report_memory(process_prefix, cpu_delta);
+		last_process_time = process_time;
+	}
+
+	if (owd_hist != nullptr)
+	{
+		printf("%llu lost (%.3lf%%), %llu reordered (mean distance %.1lf, max %llu), %llu duplicated, %llu late \n",
+			(unsigned long long)total.lost, loss_percent(total), (unsigned long long)total.reordered,
+			total.reordered > 0 ? total.reorder_distance / (double)total.reordered : 0., (unsigned long long)total.reorder_max,
+			(unsigned long long)total.duplicated, (unsigned long long)total.late);
+		printf("jitter %.1lf us (mean of links) \n", total.jitter_ns / (1000. * n_connection));
+	}
+
+	if (zerocopy_links > 0)
+	{
+		const link_sample_t copy_total{ total - zerocopy_total };
+
+		printf("zero copy: %3.3lf Mbps/link over %llu links (%llu sends copied by the kernel), copy: %3.3lf Mbps/link over %llu links \n",
+			(zerocopy_total.bytes * 8.) / (ms * 1000. * zerocopy_links), (unsigned long long)zerocopy_links,
+			(unsigned long long)zerocopy_total.zerocopy_copied,
+			n_connection > zerocopy_links ? (copy_total.bytes * 8.) / (ms * 1000. * (n_connection - zerocopy_links)) : 0.,
+			(unsigned long long)(n_connection - zerocopy_links));
+	}
+
+	report_histogram("RTT", rtt_hist, last_rtt);
+	report_histogram("one-way delay", owd_hist, last_owd);
+	report_histogram("connect latency", connect_hist, report_state.last_connect);
+
+	if (use_churn())
+		report_time_wait();
+
+	if (records.is_open())
+	{
+		record_interval(0, total, ms, last_link_latency.empty() ? nullptr : &total_latency);
+
+		if (reverse_threads != nullptr)
+			record_interval(0, reverse_total, ms, nullptr, true);
+	}
+
+	printf("\n");
+}
+
+// link_id is 1 based, 0 records the sum of all links
+void test_role_t::record_interval(const std::size_t link_id, const link_sample_t & delta, const long long ms, const histogram_sample_t * latency,
+	const bool reverse)
+{
+	interval_record_t record;
+	record.time_ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	record.elapsed_ms = report_state.elapsed_ms;
+	record.interval_ms = ms;
+	record.role = name();
+	record.direction = direction(reverse);
+	record.link_id = link_id;
+	record.bytes = delta.bytes;
+	record.packets = delta.packets;
+	record.errors = delta.errors;
+	record.lost = delta.lost;
+	record.latency = latency;
+
+	if (link_id > 0)
+	{
+		record.server_id = stats[link_id - 1].server_id + 1;
+		record.client_id = stats[link_id - 1].client_id + 1;
+		record.port_id = stats[link_id - 1].port_id + 1;
+	}
+
+	records.write(config.run().record_format() == run_config_t::record_format_t::csv ? record.to_csv() : record.to_json());
+}
+
+void test_role_t::report_histogram(const char * title, const histogram_t * hist, histogram_sample_t & last_sample)
+{
+	if (hist == nullptr)
+		return;
+
+	histogram_sample_t total, sample;
+	For(con_id, n_connection)
+	{
+		hist[con_id].sample(sample);
+		total += sample;
+	}
+
+	report_latency(title, total - last_sample, 0);
+	last_sample = total;
+}
+
+void test_role_t::report_overall(const char * title, const histogram_t * hist)
+{
+	if (hist == nullptr)
+		return;
+
+	histogram_sample_t total, sample;
+	uint64_t max{ 0 };
+
+	For(con_id, n_connection)
+	{
+		hist[con_id].sample(sample);
+		total += sample;
+		max = MAX(max, hist[con_id].max_value());
+	}
+
+	printf("overall ");
+	report_latency(title, total, max);
+	printf("\n");
+}
+
+// lost packets are only counted once they leave the receive window, so this trails the traffic by UDP_WINDOW packets
+static inline double loss_percent(const link_sample_t & sample)
+{
+	const uint64_t expected{ sample.packets - sample.duplicated - sample.late + sample.lost };
+
+	return expected > 0 ? (sample.lost * 100.) / expected : 0.;
+}
+
+// cpu_ns spent moving bytes in ms: share of one core, core cycles per byte and cpu seconds per transferred gigabit
+static void report_cpu(const char * prefix, const uint64_t cpu_ns, const uint64_t bytes, const long long ms)
+{
+	printf("%s%.1lf%% cpu (of one core), %.2lf cycles/byte, %.3lf cpu-s/Gbit \n", prefix, cpu_ns / (ms * 10000.),
+		bytes > 0 ? cpu_ns * cpu_usage::cycles_per_ns() / bytes : 0., bytes > 0 ? cpu_ns / (bytes * 8.) : 0.);
+}
+
+// page faults inside the window mean buffers or stacks were first touched while measuring
+static void report_memory(const char * prefix, const cpu_time_t & cpu_delta)
+{
+	printf("%spage faults %llu minor, %llu major", prefix, (unsigned long long)cpu_delta.minor_faults,
+		(unsigned long long)cpu_delta.major_faults);
+
+	if (cpu_usage::has_tlb_counter())
+		printf(", %llu dtlb misses", (unsigned long long)cpu_delta.tlb_misses);
+
+	printf(" \n");
+}
+
+void test_role_t::report_cpu_overall(const long long ms)
+{
+	cpu_time_t process_time;
+	const char * const process_prefix{ process_cpu_prefix() };
+	if ((ms <= 0) || (process_prefix == nullptr) || (cpu_usage::process_time(process_time) != 0))
+		return;
+
+	uint64_t bytes{ 0 };
+	For(con_id, n_connection)
+		bytes += stats[con_id].sample().bytes + (reverse_threads != nullptr ? reverse_stats[con_id].sample().bytes : 0);
+
+	const cpu_time_t cpu_delta{ process_time - run_cpu_time };
+
+	printf("overall %scpu user %.3lf s, sys %.3lf s, ", process_prefix, cpu_delta.user_ns / 1e9, cpu_delta.sys_ns / 1e9);
+	report_cpu("", cpu_delta.total_ns(), bytes, ms);
+	printf("overall ");
+	report_memory(process_prefix, cpu_delta);
+	printf("\n");
+}
+
+// both roles share the process and it has no per role cpu time, so the rx role reports it once for the two
+// against the bytes that arrived; nullptr for the tx role
+inline const char * test_role_t::process_cpu_prefix() const
+{
+	if (!tagged)
+		return "";
+
+	return config.mode() == speed_test_config_t::test_mode_t::rx ? "tx and rx " : nullptr;
+}
+
+// intervals are clean from the last link start on; epoll links have no thread of their own and are not timed
+void test_role_t::report_start_skew()
+{
+	const int64_t open_ns{ start.open_ns() };
+	int64_t first_ns{ INT64_MAX }, last_ns{ 0 };
+	std::size_t started{ 0 };
+
+	if ((poller != nullptr) || (open_ns == 0))
+		return;
+
+	For(con_id, n_connection)
+	{
+		const int64_t start_ns{ stats[con_id].start_ns.load(std::memory_order_relaxed) };
+		if (start_ns == 0)
+			continue;
+
+		first_ns = MIN(first_ns, start_ns);
+		last_ns = MAX(last_ns, start_ns);
+		++started;
+	}
+
+	if (started == 0)
+		return;
+
+	printf("start skew: %llu links began %.1lf to %.1lf us after the start (spread %.1lf us)", (unsigned long long)started,
+		(first_ns - open_ns) / 1000., (last_ns - open_ns) / 1000., (last_ns - first_ns) / 1000.);
+
+	if (started < n_connection)
+		printf(", %llu not started", (unsigned long long)(n_connection - started));
+
+	printf(" \n");
+}
+
+// links leave within a send or receive of the stop, unless they are blocked in one until the shutdown
+void test_role_t::report_stop_skew()
+{
+	if (n_connection == 0)
+		return;
+
+	if (!stopped.wait_for(STOP_WAIT_MS))
+	{
+		printf("%s%slink threads still running %d ms after the stop... \n", tagged ? name() : "", tagged ? ": " : "", STOP_WAIT_MS);
+		return;
+	}
+
+	printf("%s%sstop skew: link threads ended within %.1lf us \n", tagged ? name() : "", tagged ? ": " : "",
+		(stopped.last_ns() - stopped.first_ns()) / 1000.);
+}
+
+// closing peers leave their side of every connection in TIME_WAIT, which holds a local port for 60 s on linux
+void test_role_t::report_time_wait()
+{
+	uint64_t time_wait{ 0 };
+	int first_port, last_port;
+
+	if (ip_helper::tcp_time_wait_count(time_wait) != 0)
+		return;
+
+	if (ip_helper::local_port_range(first_port, last_port) == 0)
+		printf("%llu sockets in TIME_WAIT (%.1lf%% of the local port range) \n", (unsigned long long)time_wait,
+			(time_wait * 100.) / MAX(last_port - first_port + 1, 1));
+	else
+		printf("%llu sockets in TIME_WAIT \n", (unsigned long long)time_wait);
+}
+
+// the error is negative when the links fall short of their target, e.g. as the receiver pushes back on tcp
+void test_role_t::report_pacing(const char * prefix, const uint64_t bytes, const long long ms, const std::size_t links)
+{
+	if ((pacers == nullptr) || (ms <= 0) || (links == 0))
+		return;
+
+	const double target_mbps{ pace_bytes_per_s * 8. * links / 1e6 };
+	const double achieved_mbps{ (bytes * 8.) / (ms * 1000.) };
+
+	printf("%spacing target %3.3lf Mbps, achieved %3.3lf Mbps, error %+.3lf%% \n", prefix, target_mbps, achieved_mbps,
+		(achieved_mbps - target_mbps) * 100. / target_mbps);
+}
+
+static void report_latency(const char * title, const histogram_sample_t & sample, const uint64_t max)
+{
+	printf("%s (us) p50: %.1lf, p90: %.1lf, p99: %.1lf, p99.9: %.1lf, max: %.1lf (%llu samples) \n", title,
+		sample.quantile(0.5) / 1000., sample.quantile(0.9) / 1000., sample.quantile(0.99) / 1000., sample.quantile(0.999) / 1000.,
+		(max > 0 ? max : sample.max_value()) / 1000., (unsigned long long)sample.count());
+}
+
+void test_role_t::tx_start()
+{
+	std::size_t con_id{ 0 };
+
+	For(srv_id, config.server_count())
+	{
+		For(cli_id, config.server(srv_id).client_count())
+		{
+			For(prt_id, config.server(srv_id).client(cli_id).port_count())
+			{
+				set_link_identity(con_id, srv_id, cli_id, prt_id);
+				stats[con_id].zerocopy = use_zerocopy(con_id);
+				threads[con_id] = std::thread(&test_role_t::tx_core, this, srv_id, cli_id, prt_id, con_id);
+				++con_id;
+			}
+		}
+	}
+}
+
+void test_role_t::rx_udp_start()
+{
+	std::size_t con_id{ 0 };
+
+	if (rx_use_poller())
+		rx_link = new rx_link_t[n_connection];
+
+	For(srv_id, config.server_count())
+	{
+		For(cli_id, config.server(srv_id).client_count())
+		{
+			For(prt_id, config.server(srv_id).client(cli_id).port_count())
+			{
+				set_link_identity(con_id, srv_id, cli_id, prt_id);
+
+				if (rx_link != nullptr)
+				{
+					rx_udp_create(connection[con_id], srv_id, cli_id, prt_id);
+					rx_link[con_id].server_id = srv_id;
+					rx_link[con_id].client_id = cli_id;
+					rx_link[con_id].port_id = prt_id;
+				}
+				else
+					threads[con_id] = std::thread(&test_role_t::rx_core, this, std::ref(connection[con_id]), srv_id, cli_id, prt_id, con_id);
+
+				++con_id;
+			}
+		}
+	}
+
+	if (rx_link != nullptr)
+		rx_poll_start();
+}
+
+void test_role_t::rx_tcp_start()
+{
+	tcp_server_t * servers = new tcp_server_t[config.server_count()];
+
+	if (rx_use_poller())
+		rx_link = new rx_link_t[n_connection];
+
+	// every server listens before the first accept, so the tx peer may connect to them in any order
+	For(srv_id, config.server_count())
+	{
+		int ret = servers[srv_id].create(config.server(srv_id).ip_address(), (uint16_t)config.server(srv_id).port(), config.server(srv_id).socket_options());
+		if (ret != 0)
+		{
+			printf("%lluth server 'create' method failed on (%s %d) (Error Code: %d) \n",
+				(unsigned long long)srv_id + 1, config.server(srv_id).ip_address().c_str(), config.server(srv_id).port(), ret);
+
+			keep_on = false;
+			break;
+		}
+
+		ret = servers[srv_id].listen((int)n_connection);
+		if (ret != 0)
+		{
+			printf("%llu server 'listen' method failed on (%s %d) (Error Code: %d) \n",
+				(unsigned long long)srv_id + 1, config.server(srv_id).ip_address().c_str(), config.server(srv_id).port(), ret);
+
+			keep_on = false;
+			break;
+		}
+	}
+
+	listening.set();
+
+	// one acceptor per server, each fills the link slots of its own server
+	std::vector<std::thread> acceptors;
+	std::size_t first_link{ 0 };
+	const std::size_t n_acceptor{ keep_on ? config.server_count() : 0 };
+
+	For(srv_id, n_acceptor)
+	{
+		acceptors.emplace_back(&test_role_t::rx_tcp_accept, this, servers, srv_id, first_link);
+
+		For(cli_id, config.server(srv_id).client_count())
+			first_link += config.server(srv_id).client(cli_id).port_count();
+	}
+
+	for (std::thread & acceptor : acceptors)
+		acceptor.join();
+
+	delete[] servers; // closes the listeners
+
+	if ((rx_link != nullptr) && keep_on)
+		rx_poll_start();
+}
+
+void test_role_t::rx_tcp_accept(tcp_server_t * servers, std::size_t server_id, std::size_t first_link)
+{
+	tcp_server_t & server{ servers[server_id] };
+	std::size_t cnt{ first_link };
+
+	For(cli_id, config.server(server_id).client_count())
+	{
+		std::size_t port_id{ 0 };
+		For(prt_id, config.server(server_id).client(cli_id).port_count())
+		{
+			while (keep_on)
+			{
+				int ret = server.accept(connection[cnt]);
+				if (ret != 0)
+				{
+					if (keep_on)
+					{
+						printf("%llu server 'accept' method failed on (%s %d) (Error Code: %d) \n",
+							(unsigned long long)server_id + 1, config.server(server_id).ip_address().c_str(), config.server(server_id).port(), ret);
+					}
+
+					// wakes the acceptors of the other servers
+					keep_on = false;
+					For(srv_id, config.server_count())
+						servers[srv_id].shutdown();
+
+					break;
+				}
+
+				std::size_t client_id;
+				if (!get_client_id(connection[cnt], server_id, client_id))
+				{
+					printf("Unknown Client (%s, %d) \n", connection[cnt].pair_ip().c_str(), connection[cnt].pair_port());
+					connection[cnt].close();
+				}
+				else
+				{
+					set_link_identity(cnt, server_id, client_id, port_id);
+
+					if (rx_link != nullptr)
+					{
+						rx_link[cnt].server_id = server_id;
+						rx_link[cnt].client_id = client_id;
+						rx_link[cnt].port_id = port_id;
+					}
+					else
+						threads[cnt] = std::thread(&test_role_t::rx_core, this, std::ref(connection[cnt]), server_id, client_id, port_id, cnt);
+
+					++cnt;
+					++port_id;
+					break;
+				}
+			}
+		}
+	}
+}
+
+void test_role_t::rx_poll_start()
+{
+	n_poller = config.rx_worker_count() > 0 ? config.rx_worker_count() : (std::size_t)std::thread::hardware_concurrency();
+	n_poller = MAX(MIN(n_poller, n_connection), (std::size_t)1);
+	poller = new poller_t[n_poller];
+
+	For(wrk_id, n_poller)
+	{
+		int ret = poller[wrk_id].create();
+		if (ret != 0)
+		{
+			printf("%lluth rx worker: 'create' method failed! (Error Code: %d) \n", (unsigned long long)wrk_id + 1, ret);
+			keep_on = false;
+			return;
+		}
+	}
+
+	For(con_id, n_connection)
+	{
+		int ret = connection[con_id].set_blocking(false);
+		if (ret == 0)
+			ret = poller[con_id % n_poller].add(connection[con_id], (uint64_t)con_id);
+
+		if (ret != 0)
+		{
+			printf("%lluth server, %lluth client, %lluth port: poller registration failed! (Error Code: %d) \n",
+				(unsigned long long)rx_link[con_id].server_id + 1, (unsigned long long)rx_link[con_id].client_id + 1,
+				(unsigned long long)rx_link[con_id].port_id + 1, ret);
+			keep_on = false;
+			return;
+		}
+	}
+
+	printf("%llu links multiplexed over %llu rx workers... \n", (unsigned long long)n_connection, (unsigned long long)n_poller);
+
+	For(wrk_id, n_poller)
+		threads[wrk_id] = std::thread(&test_role_t::rx_poll_core, this, wrk_id);
+
+	connection_cnt = (int)n_connection;
+	ready.set();
+}
+
+void test_role_t::tx_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	pin_thread("link", link_id, stats[link_id].cpu);
+	buffer_pool.prefault(link_id);
+
+	if (use_churn())
+	{
+		tx_churn_core(server_id, client_id, link_id);
+		return;
+	}
+
+	char * packet = link_buffer(link_id, config.pack_len());
+	int local_pack_cnt{ 0 };
+
+	memset(packet, 0, config.pack_len());
+
+	int ret;
+	do {
+		ret = connection[link_id].create(
+			config.protocol() == speed_test_config_t::ip_protocol_t::tcp ? ip_protocol_t::tcp : ip_protocol_t::udp,
+			config.server(server_id).client(client_id).ip_address(), 0, config.server(server_id).client(client_id).socket_options());
+
+		if (ret != 0)
+		{
+			printf("%lluth port of %lluth client of %lluth server: 'create' method failed! (Error Code: %d) \n",
+				(unsigned long long)port_id + 1, (unsigned long long)client_id + 1, (unsigned long long)server_id + 1, ret);
+		}
+		else
+		{
+			uint16_t server_port{ (uint16_t)config.server(server_id).port() };
+			if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
+				server_port += (uint16_t)port_id;
+
+			ret = connection[link_id].connect(config.server(server_id).ip_address(), server_port);
+			if (ret != 0)
+			{
+				printf("%lluth port of %lluth client of %lluth server: 'connect' method failed! (Error Code: %d) \n",
+					(unsigned long long)port_id + 1, (unsigned long long)client_id + 1, (unsigned long long)server_id + 1, ret);
+			}
+			else
+			{
+				if (connection_cnt.fetch_add(1) + 1 == (int)n_connection)
+					ready.set();
+
+				wait_start(link_id);
+				break;
+			}
+		}
+
+		std::this_thread::sleep_for(750ms);
+	} while (true);
+
+	if (reverse_threads != nullptr)
+		duplex_start(link_id);
+
+	if (pacers != nullptr)
+		pace_start(link_id);
+
+	if (config.mode() == speed_test_config_t::test_mode_t::ping_pong)
+	{
+		ping_core(link_id, packet);
+		return;
+	}
+
+	if (use_uring())
+	{
+		tx_uring_core(server_id, client_id, port_id, link_id, local_pack_cnt);
+		return;
+	}
+
+	if (use_udp_batch())
+	{
+		tx_batch_core(link_id, local_pack_cnt);
+		return;
+	}
+
+	if (stats[link_id].zerocopy)
+	{
+		tx_zerocopy_core(server_id, client_id, port_id, link_id, local_pack_cnt);
+		return;
+	}
+
+	while (keep_on)
+	{
+		pace(link_id, config.pack_len());
+		tx_stamp(packet, local_pack_cnt, config.protocol() == speed_test_config_t::ip_protocol_t::udp);
+
+		ret = connection[link_id].send(packet, (int)config.pack_len());
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("packet %d send failed! (Error Code: %d) \n", local_pack_cnt - 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		stats[link_id].add_packets(1, config.pack_len());
+	}
+}
+
+void test_role_t::rx_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	pin_thread("link", link_id, stats[link_id].cpu);
+	buffer_pool.prefault(link_id);
+
+	char * packet = link_buffer(link_id, config.pack_len());
+	int32_t local_pack_cnt{ 0 };
+	udp_flow_t flow;
+	// responses that differ from the request in size, up to the configured response length
+	const int reply_len{ ping_response_len() };
+	char * reply = link_buffer(link_id, reply_len);
+	int ret{ 0 };
+
+	if (config.protocol() == speed_test_config_t::ip_protocol_t::udp)
+		ret = rx_udp_create(link, server_id, client_id, port_id);
+
+	if (ret == 0)
+	{
+		if (connection_cnt.fetch_add(1) + 1 == n_connection)
+			ready.set();
+
+		wait_start(link_id);
+
+		if (reverse_threads != nullptr)
+			duplex_start(link_id);
+	}
+
+	if (use_uring() && (ret == 0))
+	{
+		rx_uring_core(link, server_id, client_id, port_id, link_id);
+		return;
+	}
+
+	if (use_udp_batch() && (ret == 0))
+	{
+		rx_batch_core(link, server_id, client_id, port_id, link_id);
+		return;
+	}
+
+	// udp links latch onto their first sender so that pings can be echoed back
+	bool attached{ config.protocol() == speed_test_config_t::ip_protocol_t::tcp };
+
+	while (keep_on)
+	{
+		if (!attached)
+		{
+			int recvd_size;
+			std::string pair_ip;
+			uint16_t pair_port;
+
+			ret = link.recv_any_from(packet, (int)config.pack_len(), recvd_size, pair_ip, pair_port);
+			if (ret == 0)
+				ret = link.connect(pair_ip, pair_port);
+
+			attached = true;
+		}
+		else
+			ret = link.recv(packet, (int)config.pack_len());
+
+		if (ret != 0)
+		{
+			if (keep_on && !window_closed)
+			{
+				printf("%lluth server, %lluth client, %lluth port receive failed! (Error Code: %d) \n",
+					(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		stats[link_id].add_packets(1, config.pack_len());
+
+		if (config.protocol() == speed_test_config_t::ip_protocol_t::tcp)
+		{
+			if (!rx_check_sequence(packet, local_pack_cnt))
+			{
+				printf("%lluth server %dth packet corrupted! \n", (unsigned long long)server_id + 1, local_pack_cnt - 1);
+				stats[link_id].add_seq_gap();
+				keep_on = false;
+				break;
+			}
+		}
+		else
+			flow.on_packet(*(const packet_header_t*)packet, now_ns(), stats[link_id], owd_hist != nullptr ? &owd_hist[link_id] : nullptr);
+
+		if (((const packet_header_t*)packet)->flags & PACKET_FLAG_PING)
+		{
+			if (!echoed)
+				echoed = true;
+
+			// the request asks for its response length, a shorter or longer answer keeps the request header
+			const int response_len{ packet_response_len(*(const packet_header_t*)packet, config.pack_len()) };
+			const char * response{ packet };
+
+			if (response_len != config.pack_len())
+			{
+				if (response_len > reply_len)
+				{
+					if (keep_on)
+					{
+						printf("%lluth server, %lluth client, %lluth port: ping asks for a %d byte response, the rx response length is %d! \n",
+							(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, response_len, reply_len);
+						stats[link_id].add_error();
+					}
+
+					keep_on = false;
+					break;
+				}
+
+				memcpy(reply, packet, sizeof(packet_header_t));
+				response = reply;
+			}
+
+			ret = link.send(response, response_len);
+			if (ret != 0)
+			{
+				if (keep_on)
+				{
+					printf("%lluth server, %lluth client, %lluth port echo failed! (Error Code: %d) \n",
+						(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, ret);
+					stats[link_id].add_error();
+				}
+
+				keep_on = false;
+				break;
+			}
+		}
+	}
+}
+
+void test_role_t::tx_uring_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id, int & local_pack_cnt)
+{
+	const int pack_len{ config.pack_len() };
+	const unsigned depth{ (unsigned)MAX(config.io_depth(), 1) };
+	const unsigned stride{ (unsigned)(8 + pack_len - pack_len % 8) };
+	const bool is_tcp{ config.protocol() == speed_test_config_t::ip_protocol_t::tcp };
+
+	char * buffers = link_buffer(link_id, (std::size_t)stride * depth);
+	memset(buffers, 0, (std::size_t)stride * depth);
+
+	uring_t ring;
+	int ret = ring.create(connection[link_id], depth, buffers, depth, stride);
+	if (ret != 0)
+	{
+		printf("%lluth port of %lluth client of %lluth server: io_uring 'create' method failed! (Error Code: %d) \n",
+			(unsigned long long)port_id + 1, (unsigned long long)client_id + 1, (unsigned long long)server_id + 1, ret);
+		keep_on = false;
+		return;
+	}
+
+	std::vector<unsigned> free_ids;
+	For(buf_id, depth)
+		free_ids.push_back(buf_id);
+
+	unsigned in_flight{ 0 };
+	uring_completion_t completion;
+
+	while (keep_on)
+	{
+		// tcp sends go out as one linked chain and the next chain waits for it, so the stream stays in order
+		if (!is_tcp || (in_flight == 0))
+		{
+			if (is_tcp)
+				std::sort(free_ids.begin(), free_ids.end());
+
+			pace(link_id, free_ids.size() * pack_len);
+
+			For(i, free_ids.size())
+			{
+				char * packet{ buffers + (std::size_t)free_ids[i] * stride };
+				tx_stamp(packet, local_pack_cnt, !is_tcp);
+
+				ring.prep_send(free_ids[i], pack_len, free_ids[i], is_tcp && (i + 1 < free_ids.size()));
+			}
+
+			in_flight += (unsigned)free_ids.size();
+			free_ids.clear();
+		}
+
+		ret = ring.submit(is_tcp ? in_flight : 1, POLL_TIMEOUT_MS);
+
+		while ((ret == 0) && ring.reap(completion))
+		{
+			--in_flight;
+
+			if (completion.result != pack_len)
+				ret = completion.result < 0 ? -completion.result : -1;
+			else
+			{
+				stats[link_id].add_packets(1, pack_len);
+				free_ids.push_back((unsigned)completion.key);
+			}
+		}
+
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("packet %d send failed! (Error Code: %d) \n", local_pack_cnt - 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+	}
+
+	uring_drain(ring, in_flight, depth);
+	ring.close();
+}
+
+void test_role_t::rx_uring_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
+{
+	const int pack_len{ config.pack_len() };
+	const unsigned depth{ (unsigned)MAX(config.io_depth(), 1) };
+	const unsigned stride{ (unsigned)(8 + pack_len - pack_len % 8) };
+	const bool is_tcp{ config.protocol() == speed_test_config_t::ip_protocol_t::tcp };
+	int32_t local_pack_cnt{ 0 };
+	udp_flow_t flow;
+	bool chain_received{ false };
+
+	char * buffers = link_buffer(link_id, (std::size_t)stride * depth);
+
+	uring_t ring;
+	int ret = ring.create(link, depth, buffers, depth, stride);
+	if (ret != 0)
+	{
+		printf("%lluth server, %lluth client, %lluth port: io_uring 'create' method failed! (Error Code: %d) \n",
+			(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, ret);
+		keep_on = false;
+		return;
+	}
+
+	std::vector<unsigned> free_ids;
+	For(buf_id, depth)
+		free_ids.push_back(buf_id);
+
+	unsigned in_flight{ 0 };
+	uring_completion_t completion;
+
+	while (keep_on)
+	{
+		if (!is_tcp || (in_flight == 0))
+		{
+			if (is_tcp)
+			{
+				// whole chain received, verify it in stream order
+				std::sort(free_ids.begin(), free_ids.end());
+
+				if (chain_received)
+				{
+					For(i, free_ids.size())
+					{
+						if (!rx_check_sequence(buffers + (std::size_t)free_ids[i] * stride, local_pack_cnt))
+						{
+							printf("%lluth server %dth packet corrupted! \n", (unsigned long long)server_id + 1, local_pack_cnt - 1);
+							stats[link_id].add_seq_gap();
+							ret = -1;
+							break;
+						}
+					}
+				}
+
+				chain_received = true;
+			}
+
+			if (ret != 0)
+			{
+				keep_on = false;
+				break;
+			}
+
+			For(i, free_ids.size())
+				ring.prep_recv(free_ids[i], pack_len, free_ids[i], is_tcp && (i + 1 < free_ids.size()));
+
+			in_flight += (unsigned)free_ids.size();
+			free_ids.clear();
+		}
+
+		ret = ring.submit(is_tcp ? in_flight : 1, POLL_TIMEOUT_MS);
+
+		while ((ret == 0) && ring.reap(completion))
+		{
+			--in_flight;
+
+			if (completion.result <= 0)
+				ret = completion.result < 0 ? -completion.result : -1; // 0: connection closed
+			else if (is_tcp && (completion.result != pack_len))
+				ret = -1;
+			else
+			{
+				stats[link_id].add_packets(1, completion.result);
+				free_ids.push_back((unsigned)completion.key);
+
+				if (rx_reject_ping(buffers + (std::size_t)completion.key * stride))
+					keep_on = false;
+
+				if (!is_tcp)
+				{
+					flow.on_packet(*(const packet_header_t*)(buffers + (std::size_t)completion.key * stride), now_ns(),
+						stats[link_id], owd_hist != nullptr ? &owd_hist[link_id] : nullptr);
+				}
+			}
+		}
+
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("%lluth server, %lluth client, %lluth port receive failed! (Error Code: %d) \n",
+					(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+	}
+
+	uring_drain(ring, in_flight, depth);
+	ring.close();
+}
+
+// every entry in flight is keyed by its buffer id below depth; without a cancel-any one cancel per key goes out
+static void uring_cancel(uring_t & ring, const unsigned depth, const bool all)
+{
+	if (all && (ring.prep_cancel_all(URING_CANCEL_KEY) == 0))
+		return;
+
+	For(key, depth)
+		ring.prep_cancel(key, URING_CANCEL_KEY);
+}
+
+static void uring_drain(uring_t & ring, unsigned in_flight, const unsigned depth)
+{
+	if (in_flight == 0)
+		return;
+
+	uring_completion_t completion;
+
+	uring_cancel(ring, depth, true);
+	if (ring.submit(0) != 0)
+		return;
+
+	For(try_id, 10)
+	{
+		if (in_flight == 0)
+			break;
+
+		ring.submit(1, POLL_TIMEOUT_MS);
+
+		while (ring.reap(completion))
+		{
+			if (completion.key != URING_CANCEL_KEY)
+				--in_flight;
+			else if (completion.result == -EINVAL)
+				uring_cancel(ring, depth, false); // headers newer than the kernel, it knows no cancel-any
+		}
+	}
+}
+
+void test_role_t::tx_batch_core(std::size_t link_id, int & local_pack_cnt)
+{
+	const int pack_len{ config.pack_len() };
+	const int batch{ config.udp_batch() };
+	const std::size_t stride{ (std::size_t)(8 + pack_len - pack_len % 8) };
+
+	char * buffers = link_buffer(link_id, stride * batch);
+	char ** packets = (char**)link_buffer(link_id, sizeof(char*) * batch);
+
+	memset(buffers, 0, stride * batch);
+	For(pck_id, batch)
+		packets[pck_id] = buffers + stride * pck_id;
+
+	while (keep_on)
+	{
+		pace(link_id, (std::size_t)batch * pack_len);
+
+		For(pck_id, batch)
+			tx_stamp(packets[pck_id], local_pack_cnt, true);
+
+		int ret = connection[link_id].send_batch(packets, pack_len, batch);
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("packet %d send failed! (Error Code: %d) \n", local_pack_cnt - 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		stats[link_id].add_packets(batch, pack_len);
+	}
+}
+
+void test_role_t::tx_zerocopy_core(std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id, int & local_pack_cnt)
+{
+	const int pack_len{ config.pack_len() };
+
+	zerocopy_ring_t ring;
+	int ret = ring.create(connection[link_id], (unsigned)MAX(config.io_depth(), 1), (unsigned)pack_len);
+	if (ret != 0)
+	{
+		printf("%lluth port of %lluth client of %lluth server: zero copy 'create' method failed! (Error Code: %d) \n",
+			(unsigned long long)port_id + 1, (unsigned long long)client_id + 1, (unsigned long long)server_id + 1, ret);
+		keep_on = false;
+		return;
+	}
+
+	while (keep_on)
+	{
+		char * packet;
+
+		ret = ring.acquire(packet, POLL_TIMEOUT_MS);
+		if ((ret == 0) && (packet == nullptr)) // every buffer still referenced by the kernel
+			continue;
+
+		if (ret == 0)
+		{
+			pace(link_id, pack_len);
+			tx_stamp(packet, local_pack_cnt, false);
+			ret = ring.send(pack_len);
+		}
+
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("packet %d send failed! (Error Code: %d) \n", local_pack_cnt - 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		stats[link_id].add_packets(1, pack_len);
+		stats[link_id].set_zerocopy_copied(ring.copied_count());
+	}
+
+	// the kernel may still be reading the buffers
+	ring.drain(ZEROCOPY_DRAIN_MS);
+}
+
+// kernel pacing covers everything the socket sends, user space pacing waits before every send call
+void test_role_t::pace_start(std::size_t link_id)
+{
+	const int sends_per_call{ use_uring() ? MAX(config.io_depth(), 1) : use_udp_batch() ? config.udp_batch() : 1 };
+
+	if (config.pacing().engine() == pacing_config_t::engine_t::kernel)
+	{
+		int ret = connection[link_id].set_max_pacing_rate((uint64_t)pace_bytes_per_s);
+		if (ret == 0)
+			return;
+
+		printf("link %llu: kernel pacing failed, pacing in user space! (Error Code: %d) \n", (unsigned long long)link_id + 1, ret);
+	}
+
+	pacers[link_id].start(pace_bytes_per_s, config.pacing().spin_us() * 1000ll,
+		(std::size_t)PACING_BURST_SENDS * sends_per_call * config.pack_len());
+}
+
+void test_role_t::rx_batch_core(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id, std::size_t link_id)
+{
+	const int pack_len{ config.pack_len() };
+	const int batch{ config.udp_batch() };
+	const std::size_t stride{ (std::size_t)(8 + pack_len - pack_len % 8) };
+
+	char * buffers = link_buffer(link_id, stride * batch);
+	char ** packets = (char**)link_buffer(link_id, sizeof(char*) * batch);
+	int * sizes = (int*)link_buffer(link_id, sizeof(int) * batch);
+	udp_flow_t flow;
+
+	For(pck_id, batch)
+		packets[pck_id] = buffers + stride * pck_id;
+
+	while (keep_on)
+	{
+		int recvd_count;
+		int ret = link.recv_batch(packets, pack_len, batch, sizes, recvd_count);
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("%lluth server, %lluth client, %lluth port receive failed! (Error Code: %d) \n",
+					(unsigned long long)server_id + 1, (unsigned long long)client_id + 1, (unsigned long long)port_id + 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		const int64_t recv_ns{ now_ns() }; // one timestamp per batch
+
+		For(pck_id, recvd_count)
+		{
+			stats[link_id].add_packets(1, sizes[pck_id]);
+			flow.on_packet(*(const packet_header_t*)packets[pck_id], recv_ns, stats[link_id], owd_hist != nullptr ? &owd_hist[link_id] : nullptr);
+
+			if (rx_reject_ping(packets[pck_id]))
+				keep_on = false;
+		}
+	}
+}
+
+// request/response: keeps up to "outstanding" requests in flight and counts one transaction per response
+void test_role_t::ping_core(std::size_t link_id, char * packet)
+{
+	const int pack_len{ config.pack_len() };
+	const int response_len{ ping_response_len() };
+	const int depth{ MAX(config.outstanding(), 1) };
+	const bool is_tcp{ config.protocol() == speed_test_config_t::ip_protocol_t::tcp };
+	packet_header_t & header{ *(packet_header_t*)packet };
+	char * reply = link_buffer(link_id, response_len);
+	int32_t sequence{ 0 };
+	int outstanding{ 0 };
+	int64_t valid_from_ns{ 0 }; // udp responses to requests sent before the last timeout were already counted lost
+
+	int ret = connection[link_id].set_recv_timeout(PING_TIMEOUT_MS);
+
+	while ((ret == 0) && keep_on)
+	{
+		while ((outstanding < depth) && keep_on)
+		{
+			header.sequence = (sequence > (1 << 30) ? sequence = 0 : sequence)++;
+			header.flags = packet_ping_flags(response_len == pack_len ? 0 : response_len);
+			header.timestamp = now_ns();
+
+			ret = connection[link_id].send(packet, pack_len);
+			if (ret != 0)
+				break;
+
+			++outstanding;
+		}
+
+		// wait for the next response, udp requests older than PING_TIMEOUT_MS count as lost
+		int offset{ 0 };
+		while ((ret == 0) && keep_on)
+		{
+			int recvd_size;
+			ret = connection[link_id].try_recv(reply + offset, response_len - offset, recvd_size);
+			if (ret != 0)
+				break;
+
+			if (recvd_size == 0)
+			{
+				if (is_tcp)
+					continue;
+
+				for (; outstanding > 0; --outstanding)
+					stats[link_id].add_seq_gap();
+
+				valid_from_ns = now_ns();
+				break;
+			}
+
+			offset += recvd_size;
+			if (is_tcp && (offset < response_len))
+				continue;
+
+			offset = 0;
+
+			const packet_header_t & echo{ *(const packet_header_t*)reply };
+			if (echo.timestamp < valid_from_ns)
+				continue; // late udp response of an already lost request
+
+			rtt_hist[link_id].record((uint64_t)(now_ns() - echo.timestamp));
+			stats[link_id].add_packets(1, pack_len + response_len);
+			--outstanding;
+			break;
+		}
+	}
+
+	// a peer closing after the window is the end of the test, not a failure
+	if ((ret != 0) && keep_on)
+	{
+		if (!window_closed)
+		{
+			printf("ping %d failed! (Error Code: %d) \n", sequence - 1, ret);
+			stats[link_id].add_error();
+		}
+
+		keep_on = false;
+	}
+}
+
+// every acceptor listens on its own SO_REUSEPORT socket of the server address, so accepts do not serialize on one queue
+void test_role_t::rx_churn_start()
+{
+	std::size_t con_id{ 0 };
+	churn_servers = new tcp_server_t[n_connection];
+
+	For(srv_id, config.server_count())
+	{
+		socket_options_t options{ config.server(srv_id).socket_options() };
+		options.reuse_port = true;
+
+		For(cli_id, config.server(srv_id).client_count())
+		{
+			For(prt_id, config.server(srv_id).client(cli_id).port_count())
+			{
+				set_link_identity(con_id, srv_id, cli_id, prt_id);
+
+				int ret = churn_servers[con_id].create(config.server(srv_id).ip_address(), (uint16_t)config.server(srv_id).port(), options);
+				if (ret == 0)
+					ret = churn_servers[con_id].listen(CHURN_BACKLOG);
+
+				if (ret != 0)
+				{
+					printf("%lluth acceptor of %lluth server failed on (%s %d) (Error Code: %d) \n",
+						(unsigned long long)con_id + 1, (unsigned long long)srv_id + 1,
+						config.server(srv_id).ip_address().c_str(), config.server(srv_id).port(), ret);
+
+					keep_on = false;
+					return;
+				}
+
+				threads[con_id] = std::thread(&test_role_t::rx_churn_core, this, con_id);
+				++con_id;
+			}
+		}
+	}
+}
+
+// connects, exchanges churn bytes (echoed by the rx acceptor) and closes, as fast as possible
+void test_role_t::tx_churn_core(std::size_t server_id, std::size_t client_id, std::size_t link_id)
+{
+	const int churn_bytes{ MAX(config.churn_bytes(), 0) };
+	char * buffer = link_buffer(link_id, churn_bytes);
+	socket_t & link{ connection[link_id] };
+	bool failed{ false };
+
+	memset(buffer, 0, churn_bytes);
+
+	if (connection_cnt.fetch_add(1) + 1 == (int)n_connection)
+		ready.set();
+
+	wait_start(link_id);
+
+	while (keep_on)
+	{
+		const int64_t begin_ns{ now_ns() };
+
+		int ret = link.create(ip_protocol_t::tcp, config.server(server_id).client(client_id).ip_address(), 0,
+			config.server(server_id).client(client_id).socket_options());
+		if (ret == 0)
+			ret = link.connect(config.server(server_id).ip_address(), (uint16_t)config.server(server_id).port());
+		if ((ret == 0) && (churn_bytes > 0))
+			ret = link.send(buffer, churn_bytes);
+		if ((ret == 0) && (churn_bytes > 0))
+			ret = link.recv(buffer, churn_bytes);
+
+		if (ret == 0)
+		{
+			connect_hist[link_id].record((uint64_t)(now_ns() - begin_ns));
+			stats[link_id].add_packets(1, 2ull * churn_bytes);
+		}
+		else if (keep_on)
+		{
+			// out of local ports (EADDRNOTAVAIL) or a full accept queue, the link keeps trying
+			if (!failed)
+				printf("link %llu: connection failed! (Error Code: %d) \n", (unsigned long long)link_id + 1, ret);
+
+			failed = true;
+			stats[link_id].add_error();
+		}
+
+		link.close();
+	}
+}
+
+void test_role_t::rx_churn_core(std::size_t link_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	pin_thread("acceptor", link_id, stats[link_id].cpu);
+	buffer_pool.prefault(link_id);
+
+	const int churn_bytes{ MAX(config.churn_bytes(), 0) };
+	char * buffer = link_buffer(link_id, churn_bytes);
+	socket_t & link{ connection[link_id] };
+
+	if (connection_cnt.fetch_add(1) + 1 == (int)n_connection)
+		ready.set();
+
+	wait_start(link_id);
+
+	while (keep_on)
+	{
+		int ret = churn_servers[link_id].accept(link);
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("acceptor %llu: 'accept' method failed! (Error Code: %d) \n", (unsigned long long)link_id + 1, ret);
+				stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		if (churn_bytes > 0)
+		{
+			ret = link.recv(buffer, churn_bytes);
+			if (ret == 0)
+				ret = link.send(buffer, churn_bytes);
+		}
+
+		// a peer resetting one connection does not end the test
+		if (ret == 0)
+			stats[link_id].add_packets(1, 2ull * churn_bytes);
+		else if (keep_on)
+			stats[link_id].add_error();
+
+		link.close();
+	}
+}
+
+// the start time of every link shows how long after the barrier opened the last one began
+void test_role_t::wait_start(std::size_t link_id)
+{
+	start.wait();
+	stats[link_id].start_ns.store(start_barrier_t::now(), std::memory_order_relaxed);
+}
+
+void test_role_t::duplex_start(std::size_t link_id)
+{
+	reverse_threads[link_id] = std::thread(config.mode() == speed_test_config_t::test_mode_t::tx ?
+		&test_role_t::duplex_rx_core : &test_role_t::duplex_tx_core, this, link_id);
+
+	reverse_started[link_id].store(true, std::memory_order_release);
+}
+
+// the reverse thread of a link once its link thread started it, nullptr before and in half duplex; the reporter runs concurrently
+std::thread * test_role_t::reverse_thread(std::size_t link_id) const
+{
+	return (reverse_started != nullptr) && reverse_started[link_id].load(std::memory_order_acquire) ? &reverse_threads[link_id] : nullptr;
+}
+
+// the reverse direction of a full duplex link; the kernel allows one sender and one receiver thread on a socket
+void test_role_t::duplex_tx_core(std::size_t link_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	pin_thread("reverse link", link_id, reverse_stats[link_id].cpu);
+	buffer_pool.prefault(n_connection + link_id);
+
+	char * packet = link_buffer(n_connection + link_id, config.pack_len());
+	int local_pack_cnt{ 0 };
+
+	memset(packet, 0, config.pack_len());
+
+	while (keep_on)
+	{
+		tx_stamp(packet, local_pack_cnt, false);
+
+		int ret = connection[link_id].send(packet, (int)config.pack_len());
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("link %llu reverse packet %d send failed! (Error Code: %d) \n", (unsigned long long)link_id + 1, local_pack_cnt - 1, ret);
+				reverse_stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		reverse_stats[link_id].add_packets(1, config.pack_len());
+	}
+}
+
+void test_role_t::duplex_rx_core(std::size_t link_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	pin_thread("reverse link", link_id, reverse_stats[link_id].cpu);
+	buffer_pool.prefault(n_connection + link_id);
+
+	char * packet = link_buffer(n_connection + link_id, config.pack_len());
+	int32_t local_pack_cnt{ 0 };
+
+	while (keep_on)
+	{
+		int ret = connection[link_id].recv(packet, (int)config.pack_len());
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("link %llu reverse receive failed! (Error Code: %d) \n", (unsigned long long)link_id + 1, ret);
+				reverse_stats[link_id].add_error();
+			}
+
+			keep_on = false;
+			break;
+		}
+
+		reverse_stats[link_id].add_packets(1, config.pack_len());
+
+		if (!rx_check_sequence(packet, local_pack_cnt))
+		{
+			printf("link %llu reverse %dth packet corrupted! \n", (unsigned long long)link_id + 1, local_pack_cnt - 1);
+			reverse_stats[link_id].add_seq_gap();
+			keep_on = false;
+			break;
+		}
+	}
+}
+
+bool test_role_t::rx_reject_ping(const char * packet)
+{
+	if ((((const packet_header_t*)packet)->flags & PACKET_FLAG_PING) == 0)
+		return false;
+
+	if (keep_on)
+		printf("ping-pong echo needs the thread-per-link syscall rx engine! \n");
+
+	return true;
+}
+
+void test_role_t::rx_poll_core(std::size_t worker_id)
+{
+	const stop_barrier_t::scope_t running_scope{ stopped };
+
+	uint64_t keys[MAX_POLL_EVENTS];
+	int ready_count;
+
+	// links are spread as link_id % n_poller, so the worker takes the placement of its first link
+	pin_thread("rx worker", worker_id, stats[worker_id].cpu);
+
+	for (std::size_t con_id = worker_id; con_id < n_connection; con_id += n_poller)
+	{
+		buffer_pool.prefault(con_id);
+		rx_link[con_id].packet = link_buffer(con_id, config.pack_len());
+	}
+
+	start.wait();
+
+	while (keep_on)
+	{
+		int ret = poller[worker_id].wait(keys, MAX_POLL_EVENTS, POLL_TIMEOUT_MS, ready_count);
+		if (ret != 0)
+		{
+			printf("%lluth rx worker: 'wait' method failed! (Error Code: %d) \n", (unsigned long long)worker_id + 1, ret);
+			keep_on = false;
+			break;
+		}
+
+		For(evt_id, ready_count)
+		{
+			if (!rx_poll_drain(rx_link[keys[evt_id]], (std::size_t)keys[evt_id]))
+			{
+				keep_on = false;
+				break;
+			}
+		}
+	}
+}
+
+bool test_role_t::rx_poll_drain(rx_link_t & link, std::size_t link_id)
+{
+	const int pack_len{ config.pack_len() };
+	const bool is_tcp{ config.protocol() == speed_test_config_t::ip_protocol_t::tcp };
+
+	For(pck_id, MAX_POLL_PACKETS)
+	{
+		int recvd_size;
+		int ret = connection[link_id].try_recv(link.packet + link.offset, pack_len - link.offset, recvd_size);
+		if (ret != 0)
+		{
+			if (keep_on)
+			{
+				printf("%lluth server, %lluth client, %lluth port receive failed! (Error Code: %d) \n",
+					(unsigned long long)link.server_id + 1, (unsigned long long)link.client_id + 1, (unsigned long long)link.port_id + 1, ret);
+				stats[link_id].add_error();
+			}
+
+			return false;
+		}
+
+		if (recvd_size == 0)
+			break;
+
+		if (is_tcp)
+		{
+			link.offset += recvd_size;
+			if (link.offset < pack_len)
+				continue;
+
+			link.offset = 0;
+		}
+
+		stats[link_id].add_packets(1, is_tcp ? pack_len : recvd_size);
+
+		if (rx_reject_ping(link.packet))
+			return false;
+
+		if (!is_tcp)
+			link.flow.on_packet(*(const packet_header_t*)link.packet, now_ns(), stats[link_id], owd_hist != nullptr ? &owd_hist[link_id] : nullptr);
+		else if (!rx_check_sequence(link.packet, link.local_pack_cnt))
+		{
+			printf("%lluth server %dth packet corrupted! \n", (unsigned long long)link.server_id + 1, link.local_pack_cnt - 1);
+			stats[link_id].add_seq_gap();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int test_role_t::rx_udp_create(socket_t & link, std::size_t server_id, std::size_t client_id, std::size_t port_id)
+{
+	int ret;
+
+	do {
+		ret = link.create(ip_protocol_t::udp, config.server(server_id).ip_address(),
+			(uint16_t)(config.server(server_id).port() + port_id), config.server(server_id).socket_options());
+
+		if (ret == 0)
+			break;
+
+		printf("%lluth port of %lluth client of %lluth server: 'create' method failed! (Error Code: %d) \n",
+			(unsigned long long)port_id + 1, (unsigned long long)client_id + 1, (unsigned long long)server_id + 1, ret);
+
+		std::this_thread::sleep_for(750ms);
+	} while (true);
+
+	return ret;
+}
+
+static inline bool rx_check_sequence(const char * packet, int32_t & local_pack_cnt)
+{
+	return *(int32_t*)packet == (local_pack_cnt > (1 << 30) ? local_pack_cnt = 0 : local_pack_cnt)++;
+}
+
+static inline void tx_stamp(char * packet, int & local_pack_cnt, const bool is_udp)
+{
+	packet_header_t & header{ *(packet_header_t*)packet };
+
+	header.sequence = (local_pack_cnt > (1 << 30) ? local_pack_cnt = 0 : local_pack_cnt)++;
+	if (is_udp)
+		header.timestamp = now_ns();
+}
+
+void test_role_t::set_link_identity(std::size_t link_id, std::size_t server_id, std::size_t client_id, std::size_t port_id)
+{
+	stats[link_id].server_id = server_id;
+	stats[link_id].client_id = client_id;
+	stats[link_id].port_id = port_id;
+	stats[link_id].cpu = placement_cpu(link_id, server_id, client_id, port_id);
+
+	// the reverse thread of a full duplex link takes the slot after every forward link, it stays unpinned rather than
+	// share the cpu of its own link thread once the cpus run out
+	if (reverse_threads != nullptr)
+	{
+		const int cpu{ placement_cpu(n_connection + link_id, server_id, client_id,
+			config.server(server_id).client(client_id).port_count() + port_id) };
+
+		reverse_stats[link_id].cpu = cpu != stats[link_id].cpu ? cpu : -1;
+	}
+}
+
+void test_role_t::placement_init()
+{
+	if (config.cpu_affinity() != speed_test_config_t::cpu_affinity_t::automatic)
+		return;
+
+	// rx binds the server address, tx the client address
+	std::string ip;
+	if ((config.server_count() > 0) && (config.server(0).client_count() > 0))
+		ip = config.mode() == speed_test_config_t::test_mode_t::rx ? config.server(0).ip_address() : config.server(0).client(0).ip_address();
+
+	int node{ config.numa_node() };
+	if ((node < 0) && !ip.empty())
+		node = cpu_affinity::address_node(ip);
+
+	if ((cpu_affinity::node_cpus(MAX(node, 0), auto_cpus) != 0) || auto_cpus.empty())
+	{
+		printf("cpus of numa node %d are unknown, links stay unpinned... \n", MAX(node, 0));
+		return;
+	}
+
+	// the cores taking the nic's queue interrupts (and their softirq work) are left to them while others remain
+	std::vector<int> irq_cpus, free_cpus;
+	if (ip.empty() || (cpu_affinity::address_irq_cpus(ip, irq_cpus) != 0) || irq_cpus.empty())
+		return;
+
+	for (const int cpu : auto_cpus)
+	{
+		if (std::find(irq_cpus.begin(), irq_cpus.end(), cpu) == irq_cpus.end())
+			free_cpus.push_back(cpu);
+	}
+
+	if (free_cpus.empty())
+		printf("nic interrupts reach every cpu of numa node %d, links share them... \n", MAX(node, 0));
+	else if (free_cpus.size() < auto_cpus.size())
+	{
+		printf("nic interrupts on %llu of %llu cpus of numa node %d, links placed on the other %llu... \n",
+			(unsigned long long)(auto_cpus.size() - free_cpus.size()), (unsigned long long)auto_cpus.size(), MAX(node, 0),
+			(unsigned long long)free_cpus.size());
+
+		auto_cpus.swap(free_cpus);
+	}
+}
+
+int test_role_t::placement_cpu(std::size_t link_id, std::size_t server_id, std::size_t client_id, std::size_t port_id)
+{
+	switch (config.cpu_affinity())
+	{
+	case speed_test_config_t::cpu_affinity_t::client_lists:
+	{
+		std::vector<int> cpus;
+		if (!cpu_affinity::parse_list(config.server(server_id).client(client_id).cpu_list(), cpus))
+		{
+			printf("%lluth client of %lluth server: invalid cpu list '%s'! \n", (unsigned long long)client_id + 1, (unsigned long long)server_id + 1,
+				config.server(server_id).client(client_id).cpu_list().c_str());
+			return -1;
+		}
+
+		return cpus.empty() ? -1 : cpus[(placement_offset + port_id) % cpus.size()];
+	}
+	case speed_test_config_t::cpu_affinity_t::automatic:
+		return auto_cpus.empty() ? -1 : auto_cpus[(placement_offset + link_id) % auto_cpus.size()];
+	default:
+		return -1;
+	}
+}
+
+// the thread pins itself before allocating, so its buffers are first touched on its own numa node
+static void pin_thread(const char * name, std::size_t index, int cpu)
+{
+	if (cpu < 0)
+		return;
+
+	int ret = cpu_affinity::pin_current_thread(cpu);
+	if (ret != 0)
+		printf("%s %llu: pinning to cpu %d failed! (Error Code: %d) \n", name, (unsigned long long)index + 1, cpu, ret);
+}
+
+// effective values, once per client (tx) or server/client pair (rx) unless every link is reported
+void test_role_t::report_socket_options()
+{
+	printf("socket options in effect: \n");
+
+	For(con_id, n_connection)
+	{
+		if (!config.per_link_report() && (con_id > 0) &&
+			(stats[con_id].server_id == stats[con_id - 1].server_id) && (stats[con_id].client_id == stats[con_id - 1].client_id))
+			continue;
+
+		socket_options_t options;
+		int ret = connection[con_id].get_options(options);
+		if (ret != 0)
+		{
+			printf("  link %llu: reading socket options failed! (Error Code: %d) \n", (unsigned long long)con_id + 1, ret);
+			continue;
+		}
+
+		printf("  link %llu (server %llu, client %llu): send buffer %d, receive buffer %d, busy poll %d us, reuse port %d",
+			(unsigned long long)con_id + 1, (unsigned long long)stats[con_id].server_id + 1, (unsigned long long)stats[con_id].client_id + 1,
+			options.send_buffer, options.recv_buffer, options.busy_poll_us, options.reuse_port ? 1 : 0);
+
+		if (config.protocol() == speed_test_config_t::ip_protocol_t::tcp)
+		{
+			printf(", no delay %d, cork %d, not sent low watermark %d, congestion control %s",
+				options.tcp_no_delay ? 1 : 0, options.tcp_cork ? 1 : 0, options.tcp_notsent_lowat,
+				options.tcp_congestion.empty() ? "-" : options.tcp_congestion.c_str());
+		}
+
+		printf(" \n");
+	}
+}
+
+void test_role_t::report_placement()
+{
+	if (config.cpu_affinity() == speed_test_config_t::cpu_affinity_t::off)
+		return;
+
+	// epoll links have no thread of their own, the workers carry the placement
+	const std::size_t link_lines{ poller == nullptr ? n_connection : 0 };
+	For(con_id, link_lines)
+	{
+		printf("  link %llu (server %llu, client %llu, port %llu): ", (unsigned long long)con_id + 1,
+			(unsigned long long)stats[con_id].server_id + 1, (unsigned long long)stats[con_id].client_id + 1,
+			(unsigned long long)stats[con_id].port_id + 1);
+
+		if (stats[con_id].cpu < 0)
+			printf("unpinned");
+		else
+			printf("cpu %d, numa node %d", stats[con_id].cpu, cpu_affinity::cpu_node(stats[con_id].cpu));
+
+		if (reverse_threads == nullptr)
+			printf(" \n");
+		else if (reverse_stats[con_id].cpu < 0)
+			printf(", reverse link unpinned \n");
+		else
+			printf(", reverse link cpu %d, numa node %d \n", reverse_stats[con_id].cpu, cpu_affinity::cpu_node(reverse_stats[con_id].cpu));
+	}
+
+	For(wrk_id, n_poller)
+	{
+		if (stats[wrk_id].cpu >= 0)
+			printf("  rx worker %llu: cpu %d, numa node %d \n", (unsigned long long)wrk_id + 1, stats[wrk_id].cpu,
+				cpu_affinity::cpu_node(stats[wrk_id].cpu));
+	}
+}
+
+inline bool test_role_t::use_uring()
+{
+	return (config.io_backend() == speed_test_config_t::io_backend_t::io_uring) && uring_t::is_supported();
+}
+
+inline void test_role_t::pace(const std::size_t link_id, const std::size_t bytes)
+{
+	if (pacers != nullptr)
+		pacers[link_id].wait(bytes);
+}
+
+inline bool test_role_t::use_udp_batch()
+{
+	return (config.protocol() == speed_test_config_t::ip_protocol_t::udp) && (config.udp_batch() > 1);
+}
+
+inline bool test_role_t::use_zerocopy(const std::size_t link_id)
+{
+	if ((config.zerocopy() == speed_test_config_t::zerocopy_t::off) || (config.mode() != speed_test_config_t::test_mode_t::tx) ||
+		(config.protocol() != speed_test_config_t::ip_protocol_t::tcp) || !socket_t::is_zerocopy_supported() || use_uring() || use_churn())
+		return false;
+
+	// alternate links keep a copying twin next to every zero-copy link for a side by side comparison
+	return (config.zerocopy() == speed_test_config_t::zerocopy_t::on) || (link_id % 2 == 0);
+}
+
+inline bool test_role_t::use_churn()
+{
+	return config.churn() && (config.protocol() == speed_test_config_t::ip_protocol_t::tcp) &&
+		((config.mode() == speed_test_config_t::test_mode_t::tx) || (config.mode() == speed_test_config_t::test_mode_t::rx));
+}
+
+// the latency of interval records and sweep results: rtt (ping-pong), one-way delay (udp rx) or connect time (churn tx)
+inline const histogram_t * test_role_t::latency_hist() const
+{
+	return rtt_hist != nullptr ? rtt_hist : owd_hist != nullptr ? owd_hist : connect_hist;
+}
+
+// at least a packet header, within a datagram for udp and within the header flags for tcp
+inline int test_role_t::ping_response_len()
+{
+	const int response_len{ MAX(config.response_len() > 0 ? config.response_len() : config.pack_len(), (int)sizeof(packet_header_t)) };
+
+	return MIN(response_len, config.protocol() == speed_test_config_t::ip_protocol_t::udp ? MAX_UDP_PACKET_SIZE : PACKET_MAX_RESPONSE_LEN);
+}
+
+// the most one link thread takes from its slab: its packet, the io_uring or batch buffers with their
+// bookkeeping, the ping-pong response and the churn exchange; every allocation may lose an alignment's worth
+std::size_t test_role_t::buffer_slab_size()
+{
+	const std::size_t pack_len{ (std::size_t)config.pack_len() + BUFFER_ALIGNMENT };
+	const std::size_t depth{ (std::size_t)MAX(MAX(use_uring() ? config.io_depth() : 0, use_udp_batch() ? config.udp_batch() : 0), 1) };
+
+	return pack_len * (depth + 1) + (sizeof(char*) + sizeof(int)) * depth + 2 * BUFFER_ALIGNMENT +
+		ping_response_len() + BUFFER_ALIGNMENT + MAX(config.churn_bytes(), 0) + BUFFER_ALIGNMENT;
+}
+
+// only the owner of the slab allocates from it, sized by buffer_slab_size()
+char * test_role_t::link_buffer(const std::size_t slab_id, const std::size_t size)
+{
+	char * buffer{ buffer_pool.allocate(slab_id, size) };
+	ASSERTION(buffer != nullptr);
+
+	return buffer;
+}
+
+// ping-pong already uses both directions, udp rx links only learn their peer from the first packet
+inline bool test_role_t::use_duplex()
+{
+	return config.duplex() && (config.protocol() == speed_test_config_t::ip_protocol_t::tcp) && !use_uring() && !use_churn() &&
+		((config.mode() == speed_test_config_t::test_mode_t::tx) ||
+		((config.mode() == speed_test_config_t::test_mode_t::rx) && !rx_use_poller()));
+}
+
+// direction of the data counted by stats (or reverse_stats) of this role
+const char * test_role_t::direction(const bool reverse) const
+{
+	const bool sending{ config.mode() != speed_test_config_t::test_mode_t::rx };
+
+	return sending != reverse ? "tx" : "rx";
+}
+
+inline bool test_role_t::rx_use_poller()
+{
+	return (config.rx_engine() == speed_test_config_t::rx_engine_t::epoll) && poller_t::is_supported();
 }
 
-static bool get_client_id(const socket_t & link, const std::size_t server_id, std::size_t & client_id)
+bool test_role_t::get_client_id(const socket_t & link, const std::size_t server_id, std::size_t & client_id)
 {
 	For(cli_id, config.server(server_id).client_count())
 	{
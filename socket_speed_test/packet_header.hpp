@@ -0,0 +1,39 @@
+#ifndef _PACKET_HEADER_HPP_
+#define _PACKET_HEADER_HPP_
+
+#include <chrono>
+#include <stdint.h>
+
+#define PACKET_FLAG_PING 0x1u // receiver answers the packet (request/response), see packet_response_len()
+#define PACKET_RESPONSE_SHIFT 8 // the upper 24 flag bits of a ping carry its response length
+#define PACKET_MAX_RESPONSE_LEN 0xffffff
+
+// header at the start of every test packet, the rest of the packet is zero padding
+struct packet_header_t
+{
+	int32_t sequence;
+	uint32_t flags;
+	int64_t timestamp; // sender steady clock, nanoseconds
+};
+
+static_assert(sizeof(packet_header_t) == 16, "packet_header_t must stay 16 bytes!");
+
+// response_len 0 asks for an echo of the whole request
+static inline uint32_t packet_ping_flags(const int response_len)
+{
+	return PACKET_FLAG_PING | ((uint32_t)response_len << PACKET_RESPONSE_SHIFT);
+}
+
+static inline int packet_response_len(const packet_header_t & header, const int request_len)
+{
+	const int response_len{ (int)(header.flags >> PACKET_RESPONSE_SHIFT) };
+
+	return response_len > 0 ? response_len : request_len;
+}
+
+static inline int64_t now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // !_PACKET_HEADER_HPP_
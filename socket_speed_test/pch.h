@@ -33,6 +33,7 @@
 #include <numeric>
 #include <iomanip>
 #include <string.h>
+#include <memory>
 #include <memory.h>
 #include <iostream>
 #include <algorithm>
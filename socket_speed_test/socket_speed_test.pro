@@ -20,11 +20,39 @@ HEADERS += \
     util/resettable_event.h \
     util/setting_t.hpp \
     util/sockio.h \
+    util/poller.h \
+    util/uring.h \
+    util/histogram.h \
+    util/zerocopy_ring.h \
+    util/cpu_usage.h \
+    util/buffer_pool.h \
+    util/pacer.h \
+    util/cpu_affinity.h \
+    util/futex.h \
+    util/link_barrier.h \
+    util/record_sink.h \
+    util/control_channel.h \
     speed_test_config.hpp \
+    packet_header.hpp \
+    link_stats.hpp \
+    udp_flow.hpp \
+    sweep_result.hpp \
+    steady_state.hpp \
+    interval_record.hpp \
     pch.h
 
 SOURCES += \
     util/sockio.cpp \
+    util/poller.cpp \
+    util/uring.cpp \
+    util/zerocopy_ring.cpp \
+    util/cpu_usage.cpp \
+    util/buffer_pool.cpp \
+    util/pacer.cpp \
+    util/cpu_affinity.cpp \
+    util/futex.cpp \
+    util/record_sink.cpp \
+    util/control_channel.cpp \
     main.cpp \
     pch.cpp
 
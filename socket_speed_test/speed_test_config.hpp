@@ -1,18 +1,453 @@
 #ifndef _SPEED_TEST_CONFIG_HPP_
 #define _SPEED_TEST_CONFIG_HPP_
 
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
 #include "util/setting_t.hpp"
+#include "util/sockio.h"
+
+class socket_options_config_t : public group_t
+{
+private:
+	scalar_t<int> send_buffer_{ "Send Buffer (0: Default)", 0 };
+	scalar_t<int> recv_buffer_{ "Receive Buffer (0: Default)", 0 };
+	scalar_t<int> tcp_no_delay_{ "TCP No Delay (0: Off, 1: On)", 0 };
+	scalar_t<int> tcp_cork_{ "TCP Cork (0: Off, 1: On)", 0 };
+	scalar_t<int> busy_poll_{ "Busy Poll us (0: Off)", 0 };
+	scalar_t<int> tcp_notsent_lowat_{ "TCP Not Sent Low Watermark (0: Default)", 0 };
+	scalar_t<int> reuse_port_{ "Reuse Port (0: Off, 1: On)", 0 };
+	scalar_t<std::string> tcp_congestion_{ "TCP Congestion Control (Empty: Default)", "" };
+
+public:
+	socket_options_config_t(const std::string & _label = "Socket Options") : group_t(_label) {  }
+
+	std::size_t size() const
+	{
+		return 8;
+	}
+
+	const setting_t & operator()(std::size_t index) const
+	{
+		switch (index)
+		{
+		case 0:
+			return send_buffer_;
+		case 1:
+			return recv_buffer_;
+		case 2:
+			return tcp_no_delay_;
+		case 3:
+			return tcp_cork_;
+		case 4:
+			return busy_poll_;
+		case 5:
+			return tcp_notsent_lowat_;
+		case 6:
+			return reuse_port_;
+		case 7:
+			return tcp_congestion_;
+		default:
+			throw new std::invalid_argument("Invalid index!");
+		}
+	}
+
+	socket_options_t options() const
+	{
+		socket_options_t _options;
+		_options.send_buffer = send_buffer_();
+		_options.recv_buffer = recv_buffer_();
+		_options.tcp_no_delay = tcp_no_delay_() != 0;
+		_options.tcp_cork = tcp_cork_() != 0;
+		_options.busy_poll_us = busy_poll_();
+		_options.tcp_notsent_lowat = tcp_notsent_lowat_();
+		_options.reuse_port = reuse_port_() != 0;
+		_options.tcp_congestion = tcp_congestion_();
+
+		return _options;
+	}
+
+	void options(const socket_options_t & _options)
+	{
+		send_buffer_() = _options.send_buffer;
+		recv_buffer_() = _options.recv_buffer;
+		tcp_no_delay_() = _options.tcp_no_delay ? 1 : 0;
+		tcp_cork_() = _options.tcp_cork ? 1 : 0;
+		busy_poll_() = _options.busy_poll_us;
+		tcp_notsent_lowat_() = _options.tcp_notsent_lowat;
+		reuse_port_() = _options.reuse_port ? 1 : 0;
+		tcp_congestion_() = _options.tcp_congestion;
+	}
+};
+
+// tx links send at their share of the target rate instead of as fast as they can, so udp loss is measured at a
+// rate the receiver is meant to keep up with
+class pacing_config_t : public group_t
+{
+private:
+	scalar_t<double> rate_{ "Target Rate (0: Unlimited)", 0. };
+	scalar_t<int> unit_{ "Rate Unit (0: Mbps per Link, 1: pps per Link, 2: Mbps Total, 3: pps Total)", 0 };
+	scalar_t<int> engine_{ "Pacing Engine (0: User Space, 1: Kernel SO_MAX_PACING_RATE)", 0 };
+	scalar_t<int> spin_us_{ "Busy Wait below us", 50 };
+
+public:
+	pacing_config_t(const std::string & _label = "Pacing") : group_t(_label) {  }
+
+	enum class unit_t : int
+	{
+		mbps_per_link = 0,
+		pps_per_link,
+		mbps_total,
+		pps_total
+	};
+
+	enum class engine_t : int
+	{
+		user_space = 0,
+		kernel
+	};
+
+	std::size_t size() const
+	{
+		return 4;
+	}
+
+	const setting_t & operator()(std::size_t index) const
+	{
+		switch (index)
+		{
+		case 0:
+			return rate_;
+		case 1:
+			return unit_;
+		case 2:
+			return engine_;
+		case 3:
+			return spin_us_;
+		default:
+			throw new std::invalid_argument("Invalid index!");
+		}
+	}
+
+	inline bool enabled() const { return rate_() > 0.; }
+
+	inline double rate() const { return rate_(); }
+	inline void rate(double _rate) { rate_() = _rate; }
+
+	inline unit_t unit() const { return (unit_t)unit_(); }
+	inline void unit(unit_t _unit) { unit_() = (int)_unit; }
+
+	inline engine_t engine() const { return (engine_t)engine_(); }
+	inline void engine(engine_t _engine) { engine_() = (int)_engine; }
+
+	// gaps between sends shorter than this are busy waited, longer ones sleep until this is left
+	inline int spin_us() const { return spin_us_(); }
+	inline void spin_us(int _spin_us) { spin_us_() = _spin_us; }
+
+	// the target of one of link_count links sending pack_len byte packets, a total rate is split evenly
+	double link_bytes_per_s(const int pack_len, const std::size_t link_count) const
+	{
+		const bool total{ (unit() == unit_t::mbps_total) || (unit() == unit_t::pps_total) };
+		const bool pps{ (unit() == unit_t::pps_per_link) || (unit() == unit_t::pps_total) };
+		const double bytes_per_s{ pps ? rate_() * pack_len : rate_() * 1e6 / 8. };
+
+		return (total && (link_count > 0)) ? bytes_per_s / link_count : bytes_per_s;
+	}
+};
+
+// a timed run needs no user input: it warms up, measures for the duration (or until the steady state) and exits
+class run_config_t : public group_t
+{
+private:
+	scalar_t<int> duration_{ "Duration ms (0: Until Enter)", 0 };
+	scalar_t<int> warmup_{ "Warm-up ms", 0 };
+	scalar_t<int> report_interval_{ "Report Interval ms", 2500 };
+	scalar_t<int> steady_intervals_{ "Steady State Intervals (0: Off)", 0 };
+	scalar_t<double> steady_deviation_{ "Steady State Max Deviation %", 1. };
+	scalar_t<std::string> record_file_{ "Interval Record File (Empty: Off)", "" };
+	scalar_t<int> record_format_{ "Interval Record Format (0: JSON Lines, 1: CSV)", 0 };
+
+public:
+	run_config_t(const std::string & _label = "Run") : group_t(_label) {  }
+
+	enum class record_format_t : int
+	{
+		json_lines = 0,
+		csv
+	};
+
+	std::size_t size() const
+	{
+		return 7;
+	}
+
+	const setting_t & operator()(std::size_t index) const
+	{
+		switch (index)
+		{
+		case 0:
+			return duration_;
+		case 1:
+			return warmup_;
+		case 2:
+			return report_interval_;
+		case 3:
+			return steady_intervals_;
+		case 4:
+			return steady_deviation_;
+		case 5:
+			return record_file_;
+		case 6:
+			return record_format_;
+		default:
+			throw new std::invalid_argument("Invalid index!");
+		}
+	}
+
+	inline bool timed() const { return duration_() > 0; }
+
+	inline int duration() const { return duration_(); }
+	inline void duration(int _duration) { duration_() = _duration; }
+
+	inline int warmup() const { return warmup_(); }
+	inline void warmup(int _warmup) { warmup_() = _warmup; }
+
+	inline int report_interval() const { return report_interval_(); }
+	inline void report_interval(int _report_interval) { report_interval_() = _report_interval; }
+
+	// consecutive report intervals whose throughput must stay within the deviation, only for timed runs
+	inline int steady_intervals() const { return steady_intervals_(); }
+	inline void steady_intervals(int _steady_intervals) { steady_intervals_() = _steady_intervals; }
+
+	inline double steady_deviation() const { return steady_deviation_(); }
+	inline void steady_deviation(double _steady_deviation) { steady_deviation_() = _steady_deviation; }
+
+	// every report interval of every link is written to this file, the process keeps it open across sweep cells
+	inline std::string record_file() const { return record_file_(); }
+	inline void record_file(const std::string & _record_file) { record_file_() = _record_file; }
+
+	inline record_format_t record_format() const { return (record_format_t)record_format_(); }
+	inline void record_format(record_format_t _record_format) { record_format_() = (int)_record_format; }
+};
+
+// cross product of the listed values, every cell is a timed run with its warm-up discarded
+class sweep_config_t : public group_t
+{
+private:
+	scalar_t<int> enabled_{ "Sweep (0: Off, 1: On)", 0 };
+	scalar_t<std::string> protocols_{ "Protocols (Empty: Protocol, e.g. 0,1)", "" };
+	scalar_t<std::string> pack_lens_{ "Packet Lengths (Empty: Packet Length, e.g. 64,1400,65500)", "" };
+	scalar_t<std::string> port_counts_{ "Port Counts (Empty: Configured)", "" };
+	scalar_t<std::string> socket_buffers_{ "Socket Buffers (Empty: Configured)", "" };
+	scalar_t<std::string> tcp_no_delays_{ "TCP No Delay (Empty: Configured, e.g. 0,1)", "" };
+	scalar_t<int> cell_duration_{ "Cell Duration ms", 10000 };
+	scalar_t<int> warmup_{ "Cell Warm-up ms", 2000 };
+	scalar_t<std::string> result_file_{ "Result File (.csv and .json are appended)", "sweep_result" };
+
+public:
+	// comma separated integers, blanks between them are skipped; false on anything else or an int overflow
+	static bool parse_list(const std::string & list, std::vector<int> & values)
+	{
+		values.clear();
+
+		const char * cursor{ list.c_str() };
+		while (*cursor != '\0')
+		{
+			while ((*cursor == ' ') || (*cursor == '\t') || (*cursor == ','))
+				++cursor;
+
+			if (*cursor == '\0')
+				break;
+
+			char * end;
+			errno = 0;
+			const long value{ strtol(cursor, &end, 10) };
+			if ((end == cursor) || (errno == ERANGE) || (value < INT_MIN) || (value > INT_MAX))
+				return false;
+
+			values.push_back((int)value);
+
+			cursor = end;
+			if ((*cursor != '\0') && (*cursor != ',') && (*cursor != ' ') && (*cursor != '\t'))
+				return false;
+		}
+
+		return true;
+	}
+
+	// a malformed list counts as empty, which keeps the configured value
+	static std::vector<int> parse_list(const std::string & list)
+	{
+		std::vector<int> values;
+		if (!parse_list(list, values))
+			values.clear();
+
+		return values;
+	}
+
+	sweep_config_t(const std::string & _label = "Sweep") : group_t(_label) {  }
+
+	std::size_t size() const
+	{
+		return 9;
+	}
+
+	const setting_t & operator()(std::size_t index) const
+	{
+		switch (index)
+		{
+		case 0:
+			return enabled_;
+		case 1:
+			return protocols_;
+		case 2:
+			return pack_lens_;
+		case 3:
+			return port_counts_;
+		case 4:
+			return socket_buffers_;
+		case 5:
+			return tcp_no_delays_;
+		case 6:
+			return cell_duration_;
+		case 7:
+			return warmup_;
+		case 8:
+			return result_file_;
+		default:
+			throw new std::invalid_argument("Invalid index!");
+		}
+	}
+
+	inline bool enabled() const { return enabled_() != 0; }
+	inline void enabled(bool _enabled) { enabled_() = _enabled ? 1 : 0; }
+
+	// true if every list is empty or a comma separated list of integers
+	inline bool lists_valid() const
+	{
+		std::vector<int> values;
+
+		return parse_list(protocols_(), values) && parse_list(pack_lens_(), values) && parse_list(port_counts_(), values) &&
+			parse_list(socket_buffers_(), values) && parse_list(tcp_no_delays_(), values);
+	}
+
+	// empty lists keep the configured value
+	inline std::vector<int> protocols() const { return parse_list(protocols_()); }
+	inline std::vector<int> pack_lens() const { return parse_list(pack_lens_()); }
+	inline std::vector<int> port_counts() const { return parse_list(port_counts_()); }
+	inline std::vector<int> socket_buffers() const { return parse_list(socket_buffers_()); }
+	inline std::vector<int> tcp_no_delays() const { return parse_list(tcp_no_delays_()); }
+
+	inline int cell_duration() const { return cell_duration_(); }
+	inline void cell_duration(int _cell_duration) { cell_duration_() = _cell_duration; }
+
+	inline int warmup() const { return warmup_(); }
+	inline void warmup(int _warmup) { warmup_() = _warmup; }
+
+	inline std::string result_file() const { return result_file_(); }
+	inline void result_file(const std::string & _result_file) { result_file_() = _result_file; }
+};
+
+// binary search of the highest paced rate with a loss at or below the limit, one trial per probed rate;
+// the receiver's loss decides every trial, so the search runs in "both" mode or as a tx with a control port
+class search_config_t : public group_t
+{
+private:
+	scalar_t<int> enabled_{ "Rate Search (0: Off, 1: On)", 0 };
+	scalar_t<std::string> pack_lens_{ "Packet Lengths (Empty: Packet Length, e.g. 64,512,1400)", "" };
+	scalar_t<double> min_rate_{ "Min Rate Mbps Total", 1. };
+	scalar_t<double> max_rate_{ "Max Rate Mbps Total", 10000. };
+	scalar_t<double> max_loss_{ "Max Loss %", 0. };
+	scalar_t<double> resolution_{ "Resolution % of Rate", 1. };
+	scalar_t<int> trial_duration_{ "Trial Duration ms", 5000 };
+	scalar_t<int> warmup_{ "Trial Warm-up ms", 1000 };
+	scalar_t<std::string> result_file_{ "Result File (.csv and .json are appended)", "search_result" };
+
+public:
+	search_config_t(const std::string & _label = "Rate Search") : group_t(_label) {  }
+
+	std::size_t size() const
+	{
+		return 9;
+	}
+
+	const setting_t & operator()(std::size_t index) const
+	{
+		switch (index)
+		{
+		case 0:
+			return enabled_;
+		case 1:
+			return pack_lens_;
+		case 2:
+			return min_rate_;
+		case 3:
+			return max_rate_;
+		case 4:
+			return max_loss_;
+		case 5:
+			return resolution_;
+		case 6:
+			return trial_duration_;
+		case 7:
+			return warmup_;
+		case 8:
+			return result_file_;
+		default:
+			throw new std::invalid_argument("Invalid index!");
+		}
+	}
+
+	inline bool enabled() const { return enabled_() != 0; }
+	inline void enabled(bool _enabled) { enabled_() = _enabled ? 1 : 0; }
+
+	inline bool lists_valid() const
+	{
+		std::vector<int> values;
+
+		return sweep_config_t::parse_list(pack_lens_(), values);
+	}
+
+	// every packet length is searched on its own, empty keeps the configured one
+	inline std::vector<int> pack_lens() const { return sweep_config_t::parse_list(pack_lens_()); }
+
+	inline double min_rate() const { return min_rate_(); }
+	inline void min_rate(double _min_rate) { min_rate_() = _min_rate; }
+
+	inline double max_rate() const { return max_rate_(); }
+	inline void max_rate(double _max_rate) { max_rate_() = _max_rate; }
+
+	// a trial passes with at most this share of its packets lost, rfc 2544 asks for 0
+	inline double max_loss() const { return max_loss_(); }
+	inline void max_loss(double _max_loss) { max_loss_() = _max_loss; }
+
+	// the search ends once the gap between the passed and the failed rate is below this share of the failed one
+	inline double resolution() const { return resolution_(); }
+	inline void resolution(double _resolution) { resolution_() = _resolution; }
+
+	inline int trial_duration() const { return trial_duration_(); }
+	inline void trial_duration(int _trial_duration) { trial_duration_() = _trial_duration; }
+
+	inline int warmup() const { return warmup_(); }
+	inline void warmup(int _warmup) { warmup_() = _warmup; }
+
+	inline std::string result_file() const { return result_file_(); }
+	inline void result_file(const std::string & _result_file) { result_file_() = _result_file; }
+};
 
 class client_config_t : public group_t
 {
 private:
 	scalar_t<std::string> ip_address_{ "IP Address" };
 	scalar_t<std::size_t> port_count_{ "Port Count" };
+	scalar_t<std::string> cpu_list_{ "CPU List (Empty: Any, e.g. 0-3,8)", "" };
+	socket_options_config_t socket_options_;
 
 public:
 	std::size_t size() const
 	{
-		return 2;
+		return 4;
 	}
 
 	const setting_t & operator()(std::size_t index) const
@@ -23,6 +458,10 @@ public:
 			return ip_address_;
 		case 1:
 			return port_count_;
+		case 2:
+			return cpu_list_;
+		case 3:
+			return socket_options_;
 		default:
 			throw new std::invalid_argument("Invalid index!");
 		}
@@ -33,6 +472,14 @@ public:
 
 	inline std::size_t port_count() const { return port_count_(); }
 	inline void port_count(const std::size_t & _port_count) { port_count_() = _port_count; }
+
+	// cpus for the ports of this client, port i runs on the (i mod size)th entry
+	inline std::string cpu_list() const { return cpu_list_(); }
+	inline void cpu_list(const std::string & _cpu_list) { cpu_list_() = _cpu_list; }
+
+	// applied to the tx sockets bound to this client
+	inline socket_options_t socket_options() const { return socket_options_.options(); }
+	inline void socket_options(const socket_options_t & _socket_options) { socket_options_.options(_socket_options); }
 };
 
 class server_config_t : public group_t
@@ -41,11 +488,12 @@ private:
 	scalar_t<std::string> ip_address_{ "IP Address" };
 	scalar_t<int> port_{ "Port Number" };
 	vector_t<client_config_t> client_{ "Client" };
+	socket_options_config_t socket_options_;
 
 public:
 	std::size_t size() const
 	{
-		return 3;
+		return 4;
 	}
 
 	const setting_t & operator()(std::size_t index) const
@@ -58,6 +506,8 @@ public:
 			return port_;
 		case 2:
 			return client_;
+		case 3:
+			return socket_options_;
 		default:
 			throw new std::invalid_argument("Invalid index!");
 		}
@@ -71,6 +521,10 @@ public:
 
 	inline std::size_t client_count() const { return client_.size(); }
 
+	// applied to the rx sockets bound to this server
+	inline socket_options_t socket_options() const { return socket_options_.options(); }
+	inline void socket_options(const socket_options_t & _socket_options) { socket_options_.options(_socket_options); }
+
 	inline client_config_t& client(std::size_t index) { return client_(index); }
 	inline const client_config_t& client(std::size_t index) const { return client_(index); }
 };
@@ -89,12 +543,40 @@ public:
 	enum class test_mode_t : int
 	{
 		tx = 0,
-		rx
+		rx,
+		ping_pong,
+		both // tx and rx in one process, over the configured (loopback) addresses
+	};
+
+	enum class rx_engine_t : int
+	{
+		thread_per_link = 0,
+		epoll
+	};
+
+	enum class io_backend_t : int
+	{
+		syscall = 0,
+		io_uring
+	};
+
+	enum class zerocopy_t : int
+	{
+		off = 0,
+		on,
+		alternate_links
+	};
+
+	enum class cpu_affinity_t : int
+	{
+		off = 0,
+		client_lists,
+		automatic
 	};
 
 	std::size_t size() const
 	{
-		return 4;
+		return 24;
 	}
 
 	const setting_t & operator()(std::size_t index) const
@@ -108,7 +590,47 @@ public:
 		case 2:
 			return mode_;
 		case 3:
+			return duplex_;
+		case 4:
+			return response_len_;
+		case 5:
+			return outstanding_;
+		case 6:
+			return churn_;
+		case 7:
+			return churn_bytes_;
+		case 8:
 			return server_;
+		case 9:
+			return rx_engine_;
+		case 10:
+			return rx_worker_count_;
+		case 11:
+			return io_backend_;
+		case 12:
+			return io_depth_;
+		case 13:
+			return udp_batch_;
+		case 14:
+			return per_link_report_;
+		case 15:
+			return zerocopy_;
+		case 16:
+			return cpu_affinity_;
+		case 17:
+			return numa_node_;
+		case 18:
+			return huge_pages_;
+		case 19:
+			return control_port_;
+		case 20:
+			return pacing_;
+		case 21:
+			return run_;
+		case 22:
+			return sweep_;
+		case 23:
+			return search_;
 		default:
 			throw new std::invalid_argument("Invalid index!");
 		}
@@ -123,16 +645,98 @@ public:
 	inline test_mode_t mode() const { return (test_mode_t)mode_(); }
 	inline void mode(test_mode_t _mode) { mode_() = (int)_mode; }
 
+	inline bool duplex() const { return duplex_() != 0; }
+	inline void duplex(bool _duplex) { duplex_() = _duplex ? 1 : 0; }
+
+	inline int response_len() const { return response_len_(); }
+	inline void response_len(int _response_len) { response_len_() = _response_len; }
+
+	inline int outstanding() const { return outstanding_(); }
+	inline void outstanding(int _outstanding) { outstanding_() = _outstanding; }
+
+	inline bool churn() const { return churn_() != 0; }
+	inline void churn(bool _churn) { churn_() = _churn ? 1 : 0; }
+
+	inline int churn_bytes() const { return churn_bytes_(); }
+	inline void churn_bytes(int _churn_bytes) { churn_bytes_() = _churn_bytes; }
+
 	inline std::size_t server_count() const { return server_.size(); }
 
+	inline rx_engine_t rx_engine() const { return (rx_engine_t)rx_engine_(); }
+	inline void rx_engine(rx_engine_t _rx_engine) { rx_engine_() = (int)_rx_engine; }
+
+	inline std::size_t rx_worker_count() const { return rx_worker_count_(); }
+	inline void rx_worker_count(const std::size_t & _rx_worker_count) { rx_worker_count_() = _rx_worker_count; }
+
+	inline io_backend_t io_backend() const { return (io_backend_t)io_backend_(); }
+	inline void io_backend(io_backend_t _io_backend) { io_backend_() = (int)_io_backend; }
+
+	inline int io_depth() const { return io_depth_(); }
+	inline void io_depth(int _io_depth) { io_depth_() = _io_depth; }
+
+	inline int udp_batch() const { return udp_batch_(); }
+	inline void udp_batch(int _udp_batch) { udp_batch_() = _udp_batch; }
+
+	inline bool per_link_report() const { return per_link_report_() != 0; }
+	inline void per_link_report(bool _per_link_report) { per_link_report_() = _per_link_report ? 1 : 0; }
+
+	inline zerocopy_t zerocopy() const { return (zerocopy_t)zerocopy_(); }
+	inline void zerocopy(zerocopy_t _zerocopy) { zerocopy_() = (int)_zerocopy; }
+
+	inline cpu_affinity_t cpu_affinity() const { return (cpu_affinity_t)cpu_affinity_(); }
+	inline void cpu_affinity(cpu_affinity_t _cpu_affinity) { cpu_affinity_() = (int)_cpu_affinity; }
+
+	inline int numa_node() const { return numa_node_(); }
+	inline void numa_node(int _numa_node) { numa_node_() = _numa_node; }
+
+	inline bool huge_pages() const { return huge_pages_() != 0; }
+	inline void huge_pages(bool _huge_pages) { huge_pages_() = _huge_pages ? 1 : 0; }
+
+	// rx listens on it at the address of the first server and serves one test per tx peer connecting to it
+	inline bool control() const { return control_port_() > 0; }
+	inline int control_port() const { return control_port_(); }
+	inline void control_port(int _control_port) { control_port_() = _control_port; }
+
+	inline pacing_config_t& pacing() { return pacing_; }
+	inline const pacing_config_t& pacing() const { return pacing_; }
+
+	inline run_config_t& run() { return run_; }
+	inline const run_config_t& run() const { return run_; }
+
+	inline sweep_config_t& sweep() { return sweep_; }
+	inline const sweep_config_t& sweep() const { return sweep_; }
+
+	inline search_config_t& search() { return search_; }
+	inline const search_config_t& search() const { return search_; }
+
 	inline server_config_t& server(const std::size_t & index) { return server_(index); }
 	inline const server_config_t& server(const std::size_t & index) const { return server_(index); }
 
 private:
 	scalar_t<int> protocol_{ "Protocol (0: TCP, 1: UDP)" };
 	scalar_t<int> pack_len_{ "Packet Length" };
-	scalar_t<int> mode_{ "Mode (0: Tx, 1: Rx)" };
-	vector_t<server_config_t> server_{ "Server" };;
+	scalar_t<int> mode_{ "Mode (0: Tx, 1: Rx, 2: Ping-Pong, 3: Both)" };
+	scalar_t<int> duplex_{ "Full Duplex (0: Off, 1: On)", 0 };
+	scalar_t<int> response_len_{ "Ping-Pong Response Length (0: Packet Length)", 0 };
+	scalar_t<int> outstanding_{ "Ping-Pong Outstanding Requests per Link", 1 };
+	scalar_t<int> churn_{ "Connection Churn (0: Off, 1: On)", 0 };
+	scalar_t<int> churn_bytes_{ "Churn Bytes per Connection (0: Connect Only)", 0 };
+	vector_t<server_config_t> server_{ "Server" };
+	scalar_t<int> rx_engine_{ "Rx Engine (0: Thread per Link, 1: Epoll)", 0 };
+	scalar_t<std::size_t> rx_worker_count_{ "Rx Worker Count (0: One per Core)", 0 };
+	scalar_t<int> io_backend_{ "IO Backend (0: Syscall, 1: io_uring)", 0 };
+	scalar_t<int> io_depth_{ "IO Queue Depth", 32 };
+	scalar_t<int> udp_batch_{ "UDP Batch Depth (1: No Batching)", 1 };
+	scalar_t<int> per_link_report_{ "Per Link Report (0: Off, 1: On)", 0 };
+	scalar_t<int> zerocopy_{ "TCP Zero Copy Tx (0: Off, 1: On, 2: Alternate Links)", 0 };
+	scalar_t<int> cpu_affinity_{ "CPU Affinity (0: Off, 1: Client CPU Lists, 2: Auto)", 0 };
+	scalar_t<int> numa_node_{ "Auto Affinity NUMA Node (-1: Node of the Test NIC)", -1 };
+	scalar_t<int> huge_pages_{ "Packet Buffer Huge Pages (0: Off, 1: On)", 0 };
+	scalar_t<int> control_port_{ "Control Port (0: Off)", 0 };
+	pacing_config_t pacing_;
+	run_config_t run_;
+	sweep_config_t sweep_;
+	search_config_t search_;
 };
 
 #endif // !_SPEED_TEST_CONFIG_HPP_
@@ -0,0 +1,62 @@
+#ifndef _STEADY_STATE_HPP_
+#define _STEADY_STATE_HPP_
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+
+// throughput is steady once the last <window> interval rates deviate (stddev / mean) less than max_deviation percent
+class steady_state_t
+{
+public:
+	steady_state_t(const std::size_t _window = 0, const double _max_deviation = 0.) :
+		window{ _window }, max_deviation{ _max_deviation }, rates(_window, 0.) { }
+
+	inline bool enabled() const { return window > 1; }
+
+	// returns true once the window is full and steady
+	bool add(const double rate)
+	{
+		if (!enabled())
+			return false;
+
+		rates[next] = rate;
+		next = (next + 1) % window;
+		if (count < window)
+			++count;
+
+		return (count == window) && (deviation() < max_deviation);
+	}
+
+	// relative standard deviation of the window in percent
+	double deviation() const
+	{
+		if (count == 0)
+			return 0.;
+
+		double sum{ 0. };
+		for (std::size_t i = 0; i < count; ++i)
+			sum += rates[i];
+
+		const double mean{ sum / count };
+		if (mean <= 0.)
+			return 100.;
+
+		double square_sum{ 0. };
+		for (std::size_t i = 0; i < count; ++i)
+			square_sum += (rates[i] - mean) * (rates[i] - mean);
+
+		return std::sqrt(square_sum / count) / mean * 100.;
+	}
+
+	inline std::size_t size() const { return count; }
+
+private:
+	std::size_t window;
+	double max_deviation;
+	std::vector<double> rates;
+	std::size_t next{ 0 };
+	std::size_t count{ 0 };
+};
+
+#endif // !_STEADY_STATE_HPP_
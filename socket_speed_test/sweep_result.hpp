@@ -0,0 +1,228 @@
+#ifndef _SWEEP_RESULT_HPP_
+#define _SWEEP_RESULT_HPP_
+
+#include <string>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "util/cpu_usage.h"
+#include "util/histogram.h"
+
+// totals of one run at a point in time; the difference of two is the measured window
+struct run_result_t
+{
+	long long ms{ 0 };
+	uint64_t packets{ 0 };
+	uint64_t bytes{ 0 };
+	uint64_t errors{ 0 };
+	uint64_t lost{ 0 };
+	uint64_t missing{ 0 }; // still in the udp receive windows, a gauge taken from the later of two results
+	cpu_time_t cpu;
+	histogram_sample_t latency; // rtt (ping-pong) or one-way delay (udp rx), empty otherwise
+
+	run_result_t operator-(const run_result_t & other) const
+	{
+		run_result_t delta;
+		delta.ms = ms - other.ms;
+		delta.packets = packets - other.packets;
+		delta.bytes = bytes - other.bytes;
+		delta.errors = errors - other.errors;
+		delta.lost = lost - other.lost;
+		delta.missing = missing;
+		delta.cpu = cpu - other.cpu;
+		delta.latency = latency - other.latency;
+
+		return delta;
+	}
+};
+
+// swept parameters of one cell, -1 where the configured value was kept
+struct sweep_cell_t
+{
+	int protocol{ -1 };
+	int pack_len{ -1 };
+	int port_count{ -1 };
+	int socket_buffer{ -1 };
+	int tcp_no_delay{ -1 };
+};
+
+// one row per cell, written to <base>.csv and <base>.json as the sweep goes so a cut short sweep keeps its rows
+class result_matrix_t
+{
+public:
+	result_matrix_t() = default;
+	result_matrix_t(const result_matrix_t&) = delete;
+	result_matrix_t& operator=(const result_matrix_t&) = delete;
+
+	bool open(const std::string & base)
+	{
+		csv = fopen((base + ".csv").c_str(), "w");
+		json = fopen((base + ".json").c_str(), "w");
+
+		if ((csv == nullptr) || (json == nullptr))
+		{
+			close();
+			return false;
+		}
+
+		fprintf(csv, "mode,protocol,packet_length,port_count,socket_buffer,tcp_no_delay,ms,mbps,pps,errors,lost,"
+			"cpu_cores,cpu_s_per_gbit,cycles_per_byte,p50_us,p90_us,p99_us,p999_us\n");
+		fprintf(json, "[");
+		fflush(csv);
+		fflush(json);
+
+		return true;
+	}
+
+	void add(const char * mode, const sweep_cell_t & cell, const run_result_t & result)
+	{
+		if ((csv == nullptr) || (json == nullptr))
+			return;
+
+		const double ms{ result.ms > 0 ? (double)result.ms : 1. };
+		const double mbps{ (result.bytes * 8.) / (ms * 1000.) };
+		const double pps{ (result.packets * 1000.) / ms };
+		// in "both" mode the cpu is the process's, so it covers tx and rx per byte that arrived
+		const double cpu_cores{ result.cpu.total_ns() / (ms * 1e6) };
+		const double cpu_s_per_gbit{ result.bytes > 0 ? result.cpu.total_ns() / (result.bytes * 8.) : 0. };
+		const double cycles_per_byte{ result.bytes > 0 ? result.cpu.total_ns() * cpu_usage::cycles_per_ns() / result.bytes : 0. };
+		const bool has_latency{ result.latency.count() > 0 };
+
+		fprintf(csv, "%s,%d,%d,%d,%d,%d,%lld,%.3lf,%.0lf,%llu,%llu,%.3lf,%.4lf,%.3lf,", mode,
+			cell.protocol, cell.pack_len, cell.port_count, cell.socket_buffer, cell.tcp_no_delay, result.ms,
+			mbps, pps, (unsigned long long)result.errors, (unsigned long long)result.lost, cpu_cores, cpu_s_per_gbit, cycles_per_byte);
+
+		if (has_latency)
+		{
+			fprintf(csv, "%.1lf,%.1lf,%.1lf,%.1lf\n", result.latency.quantile(0.5) / 1000., result.latency.quantile(0.9) / 1000.,
+				result.latency.quantile(0.99) / 1000., result.latency.quantile(0.999) / 1000.);
+		}
+		else
+			fprintf(csv, ",,,\n");
+
+		fprintf(json, "%s\n  { \"mode\": \"%s\", \"protocol\": %d, \"packet_length\": %d, \"port_count\": %d, \"socket_buffer\": %d, "
+			"\"tcp_no_delay\": %d, \"ms\": %lld, \"mbps\": %.3lf, \"pps\": %.0lf, \"errors\": %llu, \"lost\": %llu, "
+			"\"cpu_cores\": %.3lf, \"cpu_s_per_gbit\": %.4lf, \"cycles_per_byte\": %.3lf", rows > 0 ? "," : "", mode,
+			cell.protocol, cell.pack_len, cell.port_count, cell.socket_buffer, cell.tcp_no_delay, result.ms,
+			mbps, pps, (unsigned long long)result.errors, (unsigned long long)result.lost, cpu_cores, cpu_s_per_gbit, cycles_per_byte);
+
+		if (has_latency)
+		{
+			fprintf(json, ", \"p50_us\": %.1lf, \"p90_us\": %.1lf, \"p99_us\": %.1lf, \"p999_us\": %.1lf",
+				result.latency.quantile(0.5) / 1000., result.latency.quantile(0.9) / 1000.,
+				result.latency.quantile(0.99) / 1000., result.latency.quantile(0.999) / 1000.);
+		}
+
+		fprintf(json, " }");
+
+		fflush(csv);
+		fflush(json);
+		++rows;
+	}
+
+	void close()
+	{
+		if (csv != nullptr)
+			fclose(csv);
+
+		if (json != nullptr)
+		{
+			fprintf(json, "\n]\n");
+			fclose(json);
+		}
+
+		csv = nullptr;
+		json = nullptr;
+		rows = 0;
+	}
+
+	~result_matrix_t()
+	{
+		close();
+	}
+
+private:
+	FILE * csv{ nullptr };
+	FILE * json{ nullptr };
+	std::size_t rows{ 0 };
+};
+
+// one row per searched packet length with the highest passed rate and what arrived at it,
+// written to <base>.csv and <base>.json like the sweep matrix
+class search_table_t
+{
+public:
+	search_table_t() = default;
+	search_table_t(const search_table_t&) = delete;
+	search_table_t& operator=(const search_table_t&) = delete;
+
+	bool open(const std::string & base)
+	{
+		csv = fopen((base + ".csv").c_str(), "w");
+		json = fopen((base + ".json").c_str(), "w");
+
+		if ((csv == nullptr) || (json == nullptr))
+		{
+			close();
+			return false;
+		}
+
+		fprintf(csv, "packet_length,offered_mbps,trials,ms,mbps,pps,lost,loss_percent\n");
+		fprintf(json, "[");
+		fflush(csv);
+		fflush(json);
+
+		return true;
+	}
+
+	// offered_mbps = 0 when not even the min rate passed, result is that of the passed trial
+	void add(const int pack_len, const double offered_mbps, const int trials, const run_result_t & result)
+	{
+		if ((csv == nullptr) || (json == nullptr))
+			return;
+
+		const double ms{ result.ms > 0 ? (double)result.ms : 1. };
+		const double mbps{ (result.bytes * 8.) / (ms * 1000.) };
+		const double pps{ (result.packets * 1000.) / ms };
+		const double loss{ result.packets + result.lost > 0 ? result.lost * 100. / (result.packets + result.lost) : 0. };
+
+		fprintf(csv, "%d,%.3lf,%d,%lld,%.3lf,%.0lf,%llu,%.4lf\n", pack_len, offered_mbps, trials, result.ms, mbps, pps,
+			(unsigned long long)result.lost, loss);
+
+		fprintf(json, "%s\n  { \"packet_length\": %d, \"offered_mbps\": %.3lf, \"trials\": %d, \"ms\": %lld, \"mbps\": %.3lf, "
+			"\"pps\": %.0lf, \"lost\": %llu, \"loss_percent\": %.4lf }", rows > 0 ? "," : "", pack_len, offered_mbps, trials, result.ms,
+			mbps, pps, (unsigned long long)result.lost, loss);
+
+		fflush(csv);
+		fflush(json);
+		++rows;
+	}
+
+	void close()
+	{
+		if (csv != nullptr)
+			fclose(csv);
+
+		if (json != nullptr)
+		{
+			fprintf(json, "\n]\n");
+			fclose(json);
+		}
+
+		csv = nullptr;
+		json = nullptr;
+		rows = 0;
+	}
+
+	~search_table_t()
+	{
+		close();
+	}
+
+private:
+	FILE * csv{ nullptr };
+	FILE * json{ nullptr };
+	std::size_t rows{ 0 };
+};
+
+#endif // !_SWEEP_RESULT_HPP_
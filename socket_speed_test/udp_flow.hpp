@@ -0,0 +1,152 @@
+#ifndef _UDP_FLOW_HPP_
+#define _UDP_FLOW_HPP_
+
+#include <string.h>
+#include <stdint.h>
+
+#include "packet_header.hpp"
+#include "link_stats.hpp"
+#include "util/histogram.h"
+
+#define SEQUENCE_SPACE ((1ll << 30) + 1) // tx wraps its sequence after 2^30
+#define UDP_WINDOW 1024 // sequence numbers tracked behind the highest one received (multiple of 64)
+
+// receive side view of one udp stream: loss, reordering, duplicates, one-way delay and rfc 3550 interarrival jitter
+//
+// received sequence numbers are kept in a sliding bitmap of UDP_WINDOW bits ending at the highest one seen;
+// a number that leaves the window without its bit set is lost, one that shows up behind the window is late.
+// the numbers still missing inside the window are published as a gauge, so the end of a run can count them too
+class udp_flow_t
+{
+public:
+	udp_flow_t()
+	{
+		memset(window, 0, sizeof(window));
+	}
+
+	void on_packet(const packet_header_t & header, const int64_t recv_ns, link_stats_t & stats, histogram_t * owd_hist)
+	{
+		if (!started)
+		{
+			started = true;
+			highest = first = UNWRAP_BASE;
+			highest_sequence = header.sequence;
+			set_bit(highest);
+		}
+		else
+		{
+			// sequence numbers wrap, positions in the window do not
+			const int64_t position{ highest + sequence_diff(header.sequence, highest_sequence) };
+
+			if (position > highest)
+			{
+				slide(position, stats);
+				highest = position;
+				highest_sequence = header.sequence;
+				set_bit(position);
+				stats.set_missing((uint64_t)missing);
+			}
+			else if ((position <= highest - UDP_WINDOW) || (position < first))
+			{
+				stats.add_late();
+				return;
+			}
+			else if (test_bit(position))
+			{
+				stats.add_duplicate();
+				return;
+			}
+			else
+			{
+				set_bit(position);
+				stats.add_reorder((uint64_t)(highest - position));
+				stats.set_missing((uint64_t)--missing);
+			}
+		}
+
+		// J += (|D(i-1, i)| - J) / 16, in arrival order
+		if (last_recv_ns != 0)
+		{
+			const int64_t transit_delta{ (recv_ns - last_recv_ns) - (header.timestamp - last_send_ns) };
+			jitter_ns += ((transit_delta < 0 ? -transit_delta : transit_delta) - jitter_ns) / 16.;
+			stats.set_jitter((uint64_t)jitter_ns);
+		}
+
+		last_recv_ns = recv_ns;
+		last_send_ns = header.timestamp;
+
+		// tx and rx share CLOCK_MONOTONIC only on the same host (loopback, veth/netns)
+		if (owd_hist != nullptr)
+			owd_hist->record(recv_ns > header.timestamp ? (uint64_t)(recv_ns - header.timestamp) : 0);
+	}
+
+private:
+	static constexpr int64_t UNWRAP_BASE{ 1ll << 40 };
+
+	static inline int64_t sequence_diff(const int64_t sequence, const int64_t expected)
+	{
+		int64_t diff{ sequence - expected };
+
+		if (diff > SEQUENCE_SPACE / 2)
+			diff -= SEQUENCE_SPACE;
+		else if (diff < -SEQUENCE_SPACE / 2)
+			diff += SEQUENCE_SPACE;
+
+		return diff;
+	}
+
+	// moves the window end to position, counting the numbers that drop out unreceived as lost
+	// and the ones skipped between the old and the new end as missing
+	void slide(const int64_t position, link_stats_t & stats)
+	{
+		const int64_t advance{ position - highest };
+		uint64_t lost{ 0 };
+
+		if (advance >= UDP_WINDOW)
+		{
+			for (int64_t seq = highest - UDP_WINDOW + 1; seq <= highest; ++seq)
+			{
+				if ((seq >= first) && !test_bit(seq))
+					++lost;
+			}
+
+			lost += (uint64_t)(advance - UDP_WINDOW); // skipped over without ever entering the window
+			memset(window, 0, sizeof(window));
+
+			const int64_t window_start{ position - UDP_WINDOW + 1 };
+			missing = position - (window_start > first ? window_start : first);
+		}
+		else
+		{
+			for (int64_t seq = highest - UDP_WINDOW + 1; seq <= position - UDP_WINDOW; ++seq)
+			{
+				if ((seq >= first) && !test_bit(seq))
+					++lost;
+
+				clear_bit(seq);
+			}
+
+			missing += (advance - 1) - (int64_t)lost;
+		}
+
+		if (lost > 0)
+			stats.add_lost(lost);
+	}
+
+	inline bool test_bit(const int64_t position) const { return (window[(position % UDP_WINDOW) / 64] >> (position % 64)) & 1; }
+	inline void set_bit(const int64_t position) { window[(position % UDP_WINDOW) / 64] |= 1ull << (position % 64); }
+	inline void clear_bit(const int64_t position) { window[(position % UDP_WINDOW) / 64] &= ~(1ull << (position % 64)); }
+
+	bool started{ false };
+	int64_t first{ 0 };
+	int64_t highest{ 0 };
+	int32_t highest_sequence{ 0 };
+	int64_t missing{ 0 }; // unset bits between first and highest inside the window
+	uint64_t window[UDP_WINDOW / 64];
+
+	int64_t last_recv_ns{ 0 };
+	int64_t last_send_ns{ 0 };
+	double jitter_ns{ 0. };
+};
+
+#endif // !_UDP_FLOW_HPP_
@@ -0,0 +1,134 @@
+#include <errno.h>
+#include <string.h>
+
+#include "buffer_pool.h"
+
+#ifdef __linux__
+
+#	include <sys/mman.h>
+
+#else
+
+#	include <Windows.h>
+
+#endif
+
+#define POOL_PAGE_SIZE 4096
+#define POOL_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define POOL_ALIGNMENT 64
+
+static inline std::size_t round_up(const std::size_t size, const std::size_t alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
+int buffer_pool_t::create(const std::size_t _slab_count, const std::size_t _slab_size, const bool huge_pages)
+{
+	close();
+
+	slab_count = _slab_count;
+	slab_size_ = round_up(_slab_size > 0 ? _slab_size : 1, huge_pages ? POOL_HUGE_PAGE_SIZE : POOL_PAGE_SIZE);
+	memory_size = slab_count * slab_size_;
+
+	if (memory_size == 0)
+		return 0;
+
+#ifdef __linux__
+	void * mapping{ MAP_FAILED };
+
+	if (huge_pages)
+	{
+		mapping = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (mapping != MAP_FAILED)
+			backing_ = backing_t::huge_pages;
+	}
+
+	if (mapping == MAP_FAILED)
+	{
+		mapping = mmap(nullptr, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED)
+			return errno;
+
+		backing_ = backing_t::pages;
+
+		// no huge pages reserved: ask for transparent ones, the mapping is huge page aligned often enough
+		if (huge_pages && (madvise(mapping, memory_size, MADV_HUGEPAGE) == 0))
+			backing_ = backing_t::transparent_huge_pages;
+	}
+
+	memory = (char*)mapping;
+#else
+	// large pages need SeLockMemoryPrivilege, regular pages are used on windows
+	memory = (char*)VirtualAlloc(nullptr, memory_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	if (memory == nullptr)
+		return (int)GetLastError();
+
+	backing_ = backing_t::pages;
+#endif
+
+	used = new std::size_t[slab_count]();
+
+	return 0;
+}
+
+void buffer_pool_t::prefault(const std::size_t slab_id)
+{
+	if ((memory == nullptr) || (slab_id >= slab_count))
+		return;
+
+	memset(memory + slab_id * slab_size_, 0, slab_size_);
+}
+
+char * buffer_pool_t::allocate(const std::size_t slab_id, const std::size_t size)
+{
+	if ((memory == nullptr) || (slab_id >= slab_count) || (used[slab_id] + size > slab_size_))
+		return nullptr;
+
+	char * buffer{ memory + slab_id * slab_size_ + used[slab_id] };
+	used[slab_id] = round_up(used[slab_id] + size, POOL_ALIGNMENT);
+
+	return buffer;
+}
+
+const char * buffer_pool_t::backing_name(const backing_t backing)
+{
+	switch (backing)
+	{
+	case backing_t::pages:
+		return "regular pages";
+	case backing_t::transparent_huge_pages:
+		return "transparent huge pages";
+	case backing_t::huge_pages:
+		return "huge pages";
+	default:
+		return "none";
+	}
+}
+
+int buffer_pool_t::close()
+{
+	if (memory != nullptr)
+	{
+#ifdef __linux__
+		munmap(memory, memory_size);
+#else
+		VirtualFree(memory, 0, MEM_RELEASE);
+#endif
+		memory = nullptr;
+	}
+
+	delete[] used;
+	used = nullptr;
+
+	memory_size = 0;
+	slab_count = 0;
+	slab_size_ = 0;
+	backing_ = backing_t::none;
+
+	return 0;
+}
+
+buffer_pool_t::~buffer_pool_t()
+{
+	close();
+}
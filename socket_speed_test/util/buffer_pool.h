@@ -0,0 +1,51 @@
+#ifndef _BUFFER_POOL_H_
+#define _BUFFER_POOL_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+// packet buffers of one test role: a single mapping split into equal slabs, one per link thread; a slab is
+// pre-faulted by the thread that owns it, so its pages are first touched on that thread's numa node and no page
+// fault or allocator call lands inside the measured window
+class buffer_pool_t
+{
+public:
+	enum class backing_t : int
+	{
+		none = 0,
+		pages, // regular pages
+		transparent_huge_pages, // madvise(MADV_HUGEPAGE), the kernel may still fall back to regular pages
+		huge_pages // MAP_HUGETLB, needs pages reserved in /proc/sys/vm/nr_hugepages
+	};
+
+	buffer_pool_t() = default;
+	buffer_pool_t(const buffer_pool_t&) = delete;
+	buffer_pool_t& operator=(const buffer_pool_t&) = delete;
+
+	// slab_size is rounded up to whole (huge) pages, so neighbouring slabs never share a page
+	int create(const std::size_t slab_count, const std::size_t slab_size, const bool huge_pages);
+
+	// writes every page of the slab (call it from the owning thread, after pinning)
+	void prefault(const std::size_t slab_id);
+
+	// cache line aligned bump allocation, only the owner of the slab allocates from it;
+	// nullptr once the slab is exhausted, everything is released by close()
+	char * allocate(const std::size_t slab_id, const std::size_t size);
+
+	inline backing_t backing() const { return backing_; }
+	inline std::size_t slab_size() const { return slab_size_; }
+	static const char * backing_name(const backing_t backing);
+
+	int close();
+	~buffer_pool_t();
+
+private:
+	char * memory{ nullptr };
+	std::size_t memory_size{ 0 };
+	std::size_t slab_count{ 0 };
+	std::size_t slab_size_{ 0 };
+	std::size_t * used{ nullptr }; // bytes handed out per slab
+	backing_t backing_{ backing_t::none };
+};
+
+#endif // !_BUFFER_POOL_H_
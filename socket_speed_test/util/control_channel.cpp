@@ -0,0 +1,198 @@
+#include <sstream>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "control_channel.h"
+
+#define CONTROL_MAX_MESSAGE (1 << 20) // a result message of a few thousand links stays far below it
+
+void control_message_t::set(const std::string & key, const std::string & value)
+{
+	fields[key] = value;
+}
+
+void control_message_t::set(const std::string & key, const long long value)
+{
+	fields[key] = std::to_string(value);
+}
+
+void control_message_t::set(const std::string & key, const double value)
+{
+	char text[32];
+	snprintf(text, sizeof(text), "%.17g", value);
+
+	fields[key] = text;
+}
+
+std::string control_message_t::get(const std::string & key, const std::string & fallback) const
+{
+	const auto field = fields.find(key);
+
+	return field != fields.end() ? field->second : fallback;
+}
+
+long long control_message_t::get_int(const std::string & key, const long long fallback) const
+{
+	const auto field = fields.find(key);
+	if (field == fields.end())
+		return fallback;
+
+	const char * text{ field->second.c_str() };
+	char * end;
+
+	errno = 0;
+	const long long value{ strtoll(text, &end, 10) };
+
+	return ((end != text) && (*end == '\0') && (errno != ERANGE)) ? value : fallback;
+}
+
+double control_message_t::get_double(const std::string & key, const double fallback) const
+{
+	const auto field = fields.find(key);
+	if (field == fields.end())
+		return fallback;
+
+	const char * text{ field->second.c_str() };
+	char * end;
+
+	errno = 0;
+	const double value{ strtod(text, &end) };
+
+	return ((end != text) && (*end == '\0') && (errno != ERANGE)) ? value : fallback;
+}
+
+std::string control_message_t::encode() const
+{
+	std::string text{ verb_ };
+
+	for (const auto & field : fields)
+		text += "\n" + field.first + "=" + field.second;
+
+	return text;
+}
+
+bool control_message_t::decode(const std::string & text)
+{
+	std::istringstream stream(text);
+	std::string line;
+
+	fields.clear();
+	if (!std::getline(stream, verb_) || verb_.empty())
+		return false;
+
+	while (std::getline(stream, line))
+	{
+		const std::size_t separator{ line.find('=') };
+		if (separator == std::string::npos)
+			return false;
+
+		fields[line.substr(0, separator)] = line.substr(separator + 1);
+	}
+
+	return true;
+}
+
+int control_channel_t::connect(const std::string & ip, const uint16_t port)
+{
+	socket_options_t options;
+	options.tcp_no_delay = true; // messages are small and every one of them is waited for
+
+	int ret = link.create(ip_protocol_t::tcp, "", 0, options);
+	if (ret != 0)
+		return ret;
+
+	ret = link.connect(ip, port); // closes the socket on failure
+	if (ret != 0)
+		return ret;
+
+	open = true;
+
+	return 0;
+}
+
+int control_channel_t::accept(tcp_server_t & listener)
+{
+	int ret = listener.accept(link);
+	if (ret != 0)
+		return ret;
+
+	socket_options_t options;
+	options.tcp_no_delay = true;
+	link.set_options(options);
+
+	open = true;
+
+	return 0;
+}
+
+int control_channel_t::send(const control_message_t & message)
+{
+	if (!open)
+		return -1;
+
+	const std::string text{ message.encode() };
+	const uint32_t length{ htonl((uint32_t)text.size()) };
+
+	int ret = link.send((const char*)&length, sizeof(length));
+	if (ret == 0)
+		ret = link.send(text.data(), (int)text.size());
+
+	// socket_t closes itself on errors
+	if (ret != 0)
+		open = false;
+
+	return ret;
+}
+
+int control_channel_t::recv(control_message_t & message)
+{
+	if (!open)
+		return -1;
+
+	uint32_t length;
+
+	int ret = link.recv((char*)&length, sizeof(length));
+	if (ret != 0)
+	{
+		open = false;
+		return ret;
+	}
+
+	length = ntohl(length);
+	if (length > CONTROL_MAX_MESSAGE)
+	{
+		close();
+		return -1;
+	}
+
+	std::string text(length, '\0');
+	if (length > 0)
+	{
+		ret = link.recv(&text[0], (int)length);
+		if (ret != 0)
+		{
+			open = false;
+			return ret;
+		}
+	}
+
+	return message.decode(text) ? 0 : -1;
+}
+
+int control_channel_t::shutdown()
+{
+	return link.shutdown();
+}
+
+int control_channel_t::close()
+{
+	open = false;
+
+	return link.close();
+}
+
+control_channel_t::~control_channel_t()
+{
+	close();
+}
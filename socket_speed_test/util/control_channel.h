@@ -0,0 +1,66 @@
+#ifndef _CONTROL_CHANNEL_H_
+#define _CONTROL_CHANNEL_H_
+
+#include <map>
+#include <string>
+#include <stdint.h>
+
+#include "sockio.h"
+
+// a verb and its key=value fields, e.g. "setup" with protocol=1 and pack_len=1400; values may hold any byte but '\n'
+class control_message_t
+{
+public:
+	control_message_t(const std::string & _verb = "") : verb_{ _verb } {  }
+
+	inline const std::string & verb() const { return verb_; }
+	inline bool is(const char * _verb) const { return verb_ == _verb; }
+
+	void set(const std::string & key, const std::string & value);
+	void set(const std::string & key, const long long value);
+	void set(const std::string & key, const double value);
+
+	inline bool has(const std::string & key) const { return fields.find(key) != fields.end(); }
+	std::string get(const std::string & key, const std::string & fallback = "") const;
+	// the fallback also stands in for a value that is not a whole number in range
+	long long get_int(const std::string & key, const long long fallback = 0) const;
+	double get_double(const std::string & key, const double fallback = 0.) const;
+
+	// the verb line followed by one line per field
+	std::string encode() const;
+	bool decode(const std::string & text);
+
+private:
+	std::string verb_;
+	std::map<std::string, std::string> fields;
+};
+
+// the tcp connection a tx peer opens to its rx peer to agree on a test, start and stop it together and get
+// the receiver's statistics back; every message is a 4 byte big endian length and the encoded text
+class control_channel_t
+{
+public:
+	control_channel_t() = default;
+	control_channel_t(const control_channel_t&) = delete;
+	control_channel_t& operator=(const control_channel_t&) = delete;
+
+	int connect(const std::string & ip, const uint16_t port);
+	int accept(tcp_server_t & listener);
+
+	int send(const control_message_t & message);
+	// blocks until a whole message arrived, the peer closing the channel is an error
+	int recv(control_message_t & message);
+
+	inline bool is_open() const { return open; }
+
+	// wakes a recv blocked on this channel from another thread
+	int shutdown();
+	int close();
+	~control_channel_t();
+
+private:
+	socket_t link;
+	bool open{ false };
+};
+
+#endif // !_CONTROL_CHANNEL_H_
@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <algorithm>
+
+#include "cpu_affinity.h"
+
+#ifdef __linux__
+
+#	include <errno.h>
+#	include <pthread.h>
+#	include <sched.h>
+#	include <dirent.h>
+#	include <ifaddrs.h>
+#	include <arpa/inet.h>
+#	include <netinet/in.h>
+
+#else
+
+#	include <Windows.h>
+
+#endif
+
+#ifdef __linux__
+const int cpu_affinity::max_cpus{ CPU_SETSIZE };
+#else
+const int cpu_affinity::max_cpus{ 64 }; // SetThreadAffinityMask within the processor group
+#endif
+
+bool cpu_affinity::parse_list(const std::string & list, std::vector<int> & cpus)
+{
+	cpus.clear();
+
+	const char * cursor{ list.c_str() };
+	while (*cursor != '\0')
+	{
+		while ((*cursor == ' ') || (*cursor == ','))
+			++cursor;
+
+		if (*cursor == '\0')
+			break;
+
+		char * end;
+		const long first{ strtol(cursor, &end, 10) };
+		if ((end == cursor) || (first < 0) || (first >= max_cpus))
+			return false;
+
+		long last{ first };
+		cursor = end;
+		if (*cursor == '-')
+		{
+			last = strtol(cursor + 1, &end, 10);
+			if ((end == cursor + 1) || (last < first) || (last >= max_cpus))
+				return false;
+
+			cursor = end;
+		}
+
+		for (long cpu = first; cpu <= last; ++cpu)
+			cpus.push_back((int)cpu);
+
+		if ((*cursor != '\0') && (*cursor != ',') && (*cursor != ' ') && (*cursor != '\n'))
+			return false;
+	}
+
+	return true;
+}
+
+#ifdef __linux__
+
+static bool read_line(const std::string & path, std::string & line)
+{
+	FILE * file = fopen(path.c_str(), "r");
+	if (file == nullptr)
+		return false;
+
+	char buffer[4096];
+	const bool ok{ fgets(buffer, sizeof(buffer), file) != nullptr };
+	fclose(file);
+
+	if (ok)
+	{
+		line = buffer;
+		while (!line.empty() && (line.back() == '\n'))
+			line.pop_back();
+	}
+
+	return ok;
+}
+
+int cpu_affinity::node_cpus(const int node, std::vector<int> & cpus)
+{
+	std::string list;
+
+	if (!read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", list) &&
+		!read_line("/sys/devices/system/cpu/online", list))
+		return ENOENT;
+
+	return parse_list(list, cpus) ? 0 : EINVAL;
+}
+
+int cpu_affinity::cpu_node(const int cpu)
+{
+	std::string list;
+	std::vector<int> nodes, cpus;
+
+	if (!read_line("/sys/devices/system/node/online", list) || !parse_list(list, nodes))
+		return -1;
+
+	for (const int node : nodes)
+	{
+		if (!read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", list) || !parse_list(list, cpus))
+			continue;
+
+		for (const int node_cpu : cpus)
+		{
+			if (node_cpu == cpu)
+				return node;
+		}
+	}
+
+	return -1;
+}
+
+// name of the network device carrying a local ipv4 address
+static bool address_device(const std::string & ip, std::string & device)
+{
+	ifaddrs * addresses;
+	if (getifaddrs(&addresses) != 0)
+		return false;
+
+	bool found{ false };
+	const in_addr_t target{ inet_addr(ip.c_str()) };
+
+	for (ifaddrs * address = addresses; address != nullptr; address = address->ifa_next)
+	{
+		if ((address->ifa_addr == nullptr) || (address->ifa_addr->sa_family != AF_INET) ||
+			(((sockaddr_in*)address->ifa_addr)->sin_addr.s_addr != target))
+			continue;
+
+		device = address->ifa_name;
+		found = true;
+		break;
+	}
+
+	freeifaddrs(addresses);
+
+	return found;
+}
+
+int cpu_affinity::address_node(const std::string & ip)
+{
+	std::string device, line;
+
+	// virtual devices (lo, bridges, veth) have no device/numa_node
+	if (!address_device(ip, device) || !read_line("/sys/class/net/" + device + "/device/numa_node", line))
+		return -1;
+
+	return atoi(line.c_str());
+}
+
+int cpu_affinity::address_irq_cpus(const std::string & ip, std::vector<int> & cpus)
+{
+	std::string device;
+	std::vector<int> irqs;
+
+	cpus.clear();
+	if (!address_device(ip, device))
+		return ENODEV;
+
+	// one msi(-x) vector per queue on multi-queue nics, virtual devices have none
+	DIR * directory = opendir(("/sys/class/net/" + device + "/device/msi_irqs").c_str());
+	if (directory != nullptr)
+	{
+		while (dirent * entry = readdir(directory))
+		{
+			if (entry->d_name[0] != '.')
+				irqs.push_back(atoi(entry->d_name));
+		}
+
+		closedir(directory);
+	}
+
+	std::string line;
+	if (irqs.empty() && read_line("/sys/class/net/" + device + "/device/irq", line) && (atoi(line.c_str()) > 0))
+		irqs.push_back(atoi(line.c_str()));
+
+	if (irqs.empty())
+		return ENOENT;
+
+	std::vector<int> irq_cpus;
+	for (const int irq : irqs)
+	{
+		if (!read_line("/proc/irq/" + std::to_string(irq) + "/smp_affinity_list", line) || !parse_list(line, irq_cpus))
+			continue;
+
+		for (const int cpu : irq_cpus)
+		{
+			if (std::find(cpus.begin(), cpus.end(), cpu) == cpus.end())
+				cpus.push_back(cpu);
+		}
+	}
+
+	std::sort(cpus.begin(), cpus.end());
+
+	return 0;
+}
+
+int cpu_affinity::pin_current_thread(const int cpu)
+{
+	if ((cpu < 0) || (cpu >= max_cpus))
+		return EINVAL;
+
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	CPU_SET(cpu, &cpu_set);
+
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+#else
+
+int cpu_affinity::node_cpus(const int node, std::vector<int> & cpus)
+{
+	ULONGLONG mask{ 0 };
+	if ((node < 0) || !GetNumaNodeProcessorMask((UCHAR)node, &mask) || (mask == 0))
+	{
+		if (node != 0)
+			return ERROR_INVALID_PARAMETER;
+
+		mask = 0;
+		for (unsigned cpu = 0; (cpu < 64) && (cpu < std::thread::hardware_concurrency()); ++cpu)
+			mask |= 1ull << cpu;
+	}
+
+	cpus.clear();
+	for (int cpu = 0; cpu < 64; ++cpu)
+	{
+		if (mask & (1ull << cpu))
+			cpus.push_back(cpu);
+	}
+
+	return 0;
+}
+
+int cpu_affinity::cpu_node(const int cpu)
+{
+	UCHAR node;
+	if (!GetNumaProcessorNode((UCHAR)cpu, &node) || (node == 0xff))
+		return -1;
+
+	return (int)node;
+}
+
+int cpu_affinity::address_node(const std::string & ip)
+{
+	(void)ip;
+
+	return -1;
+}
+
+int cpu_affinity::address_irq_cpus(const std::string & ip, std::vector<int> & cpus)
+{
+	(void)ip;
+	cpus.clear();
+
+	return ERROR_NOT_SUPPORTED;
+}
+
+int cpu_affinity::pin_current_thread(const int cpu)
+{
+	if ((cpu < 0) || (cpu >= max_cpus))
+		return ERROR_INVALID_PARAMETER;
+
+	if (SetThreadAffinityMask(GetCurrentThread(), 1ull << cpu) == 0)
+		return (int)GetLastError();
+
+	return 0;
+}
+
+#endif
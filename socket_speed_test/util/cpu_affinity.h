@@ -0,0 +1,33 @@
+#ifndef _CPU_AFFINITY_H_
+#define _CPU_AFFINITY_H_
+
+#include <string>
+#include <vector>
+
+// cpu pinning and numa topology queries (sysfs + pthread affinity on linux)
+class cpu_affinity
+{
+public:
+	cpu_affinity() = delete;
+
+	// "0-3,8,10-11" -> { 0, 1, 2, 3, 8, 10, 11 }; false on malformed input or an id past the last pinnable cpu
+	static bool parse_list(const std::string & list, std::vector<int> & cpus);
+
+	// cpus of a numa node, every online cpu if the machine reports no numa topology
+	static int node_cpus(const int node, std::vector<int> & cpus);
+
+	// numa node of a cpu, or of the network device carrying a local ipv4 address (-1 if unknown)
+	static int cpu_node(const int cpu);
+	static int address_node(const std::string & ip);
+
+	// cpus the interrupts of that network device's queues are routed to (msi irqs, else its legacy irq)
+	static int address_irq_cpus(const std::string & ip, std::vector<int> & cpus);
+
+	// pins the calling thread; memory it touches first afterwards is placed on the local node
+	static int pin_current_thread(const int cpu);
+
+	// cpu ids run from 0 to below this, the size of the affinity mask
+	static const int max_cpus;
+};
+
+#endif // !_CPU_AFFINITY_H_
@@ -0,0 +1,180 @@
+#include <chrono>
+#include <stdio.h>
+
+#include "cpu_usage.h"
+
+#ifdef __linux__
+
+#	include <errno.h>
+#	include <pthread.h>
+#	include <string.h>
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/resource.h>
+#	include <sys/syscall.h>
+#	include <linux/perf_event.h>
+
+#else
+
+#	include <Windows.h>
+
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <x86intrin.h>
+#	define HAS_TSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#	include <intrin.h>
+#	define HAS_TSC
+#endif
+
+#define CALIBRATION_MS 100
+
+#ifdef __linux__
+
+static int tlb_counter_id{ -1 };
+
+static inline uint64_t to_ns(const timeval & time)
+{
+	return (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_usec * 1000ull;
+}
+
+int cpu_usage::process_time(cpu_time_t & time)
+{
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return errno;
+
+	time.user_ns = to_ns(usage.ru_utime);
+	time.sys_ns = to_ns(usage.ru_stime);
+	time.minor_faults = (uint64_t)usage.ru_minflt;
+	time.major_faults = (uint64_t)usage.ru_majflt;
+
+	// an inherited counter reads as the sum over the process and its live threads
+	uint64_t misses{ 0 };
+	if ((tlb_counter_id >= 0) && (read(tlb_counter_id, &misses, sizeof(misses)) == (ssize_t)sizeof(misses)))
+		time.tlb_misses = misses;
+
+	return 0;
+}
+
+int cpu_usage::open_tlb_counter()
+{
+	if (tlb_counter_id >= 0)
+		return 0;
+
+	perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = PERF_TYPE_HW_CACHE;
+	attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	attr.inherit = 1;
+	attr.exclude_hv = 1;
+
+	const long id{ syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0) };
+	if (id < 0)
+		return errno;
+
+	tlb_counter_id = (int)id;
+
+	return 0;
+}
+
+bool cpu_usage::has_tlb_counter()
+{
+	return tlb_counter_id >= 0;
+}
+
+int cpu_usage::thread_time(std::thread & thread, uint64_t & cpu_ns)
+{
+	clockid_t clock_id;
+	int ret = pthread_getcpuclockid(thread.native_handle(), &clock_id);
+	if (ret != 0)
+		return ret;
+
+	timespec time;
+	if (clock_gettime(clock_id, &time) != 0)
+		return errno;
+
+	cpu_ns = (uint64_t)time.tv_sec * 1000000000ull + (uint64_t)time.tv_nsec;
+
+	return 0;
+}
+
+#else
+
+// FILETIME counts 100 ns units
+static inline uint64_t to_ns(const FILETIME & time)
+{
+	return ((((uint64_t)time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100ull;
+}
+
+int cpu_usage::process_time(cpu_time_t & time)
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+		return (int)GetLastError();
+
+	time.user_ns = to_ns(user);
+	time.sys_ns = to_ns(kernel);
+
+	return 0;
+}
+
+int cpu_usage::open_tlb_counter()
+{
+	return ERROR_NOT_SUPPORTED;
+}
+
+bool cpu_usage::has_tlb_counter()
+{
+	return false;
+}
+
+int cpu_usage::thread_time(std::thread & thread, uint64_t & cpu_ns)
+{
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(thread.native_handle(), &creation, &exit, &kernel, &user))
+		return (int)GetLastError();
+
+	cpu_ns = to_ns(user) + to_ns(kernel);
+
+	return 0;
+}
+
+#endif
+
+double cpu_usage::cycles_per_ns()
+{
+	static const double frequency = []() -> double
+	{
+#ifdef HAS_TSC
+		// an invariant tsc ticks at the nominal clock, whatever the current p-state is
+		const auto begin_time = std::chrono::steady_clock::now();
+		const uint64_t begin_tsc = __rdtsc();
+
+		while (std::chrono::steady_clock::now() - begin_time < std::chrono::milliseconds(CALIBRATION_MS));
+
+		const uint64_t end_tsc = __rdtsc();
+		const auto elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin_time).count();
+
+		return elapsed_ns > 0 ? (end_tsc - begin_tsc) / (double)elapsed_ns : 0.;
+#elif defined(__linux__)
+		unsigned long long khz{ 0 };
+		FILE * file = fopen("/sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq", "r");
+		if (file != nullptr)
+		{
+			if (fscanf(file, "%llu", &khz) != 1)
+				khz = 0;
+
+			fclose(file);
+		}
+
+		return khz / 1000000.;
+#else
+		return 0.;
+#endif
+	}();
+
+	return frequency;
+}
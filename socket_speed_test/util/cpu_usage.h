@@ -0,0 +1,51 @@
+#ifndef _CPU_USAGE_H_
+#define _CPU_USAGE_H_
+
+#include <thread>
+#include <stdint.h>
+
+struct cpu_time_t
+{
+	uint64_t user_ns{ 0 };
+	uint64_t sys_ns{ 0 };
+
+	// linux only, 0 elsewhere
+	uint64_t minor_faults{ 0 };
+	uint64_t major_faults{ 0 };
+	uint64_t tlb_misses{ 0 }; // data tlb load misses, 0 unless open_tlb_counter() succeeded
+
+	inline uint64_t total_ns() const { return user_ns + sys_ns; }
+
+	cpu_time_t operator-(const cpu_time_t & other) const
+	{
+		cpu_time_t delta;
+		delta.user_ns = user_ns - other.user_ns;
+		delta.sys_ns = sys_ns - other.sys_ns;
+		delta.minor_faults = minor_faults - other.minor_faults;
+		delta.major_faults = major_faults - other.major_faults;
+		delta.tlb_misses = tlb_misses - other.tlb_misses;
+
+		return delta;
+	}
+};
+
+// cpu time consumed by the process and by single threads (getrusage/thread cpu clocks on linux)
+class cpu_usage
+{
+public:
+	cpu_usage() = delete;
+
+	static int process_time(cpu_time_t & time);
+
+	// counts the tlb misses of the process and of every thread it starts afterwards (perf events, usually
+	// restricted by kernel.perf_event_paranoid); call it before the first test thread starts
+	static int open_tlb_counter();
+	static bool has_tlb_counter();
+	// user + sys time of a running thread, readable from any other thread
+	static int thread_time(std::thread & thread, uint64_t & cpu_ns);
+
+	// nominal core clock, measured once against the time stamp counter (0 if unknown)
+	static double cycles_per_ns();
+};
+
+#endif // !_CPU_USAGE_H_
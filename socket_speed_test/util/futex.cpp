@@ -0,0 +1,48 @@
+#include "futex.h"
+
+#ifdef __linux__
+
+#	include <time.h>
+#	include <unistd.h>
+#	include <sys/syscall.h>
+#	include <linux/futex.h>
+
+#else
+
+#	include <Windows.h>
+#	pragma comment(lib, "Synchronization.lib")
+
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "a futex word is a plain 32 bit integer");
+
+void futex::wait(const std::atomic<uint32_t> & word, const uint32_t expected, const int timeout_ms)
+{
+#ifdef __linux__
+	timespec timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_nsec = (timeout_ms % 1000) * 1000000l;
+
+	syscall(SYS_futex, (const uint32_t*)&word, FUTEX_WAIT_PRIVATE, expected, timeout_ms < 0 ? nullptr : &timeout, nullptr, 0);
+#else
+	WaitOnAddress((volatile VOID*)&word, (PVOID)&expected, sizeof(expected), timeout_ms < 0 ? INFINITE : (DWORD)timeout_ms);
+#endif
+}
+
+void futex::wake_one(const std::atomic<uint32_t> & word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (const uint32_t*)&word, FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else
+	WakeByAddressSingle((PVOID)&word);
+#endif
+}
+
+void futex::wake_all(const std::atomic<uint32_t> & word)
+{
+#ifdef __linux__
+	syscall(SYS_futex, (const uint32_t*)&word, FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+	WakeByAddressAll((PVOID)&word);
+#endif
+}
@@ -0,0 +1,27 @@
+#ifndef _FUTEX_H_
+#define _FUTEX_H_
+
+#include <atomic>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#	include <immintrin.h>
+#	define spin_pause() _mm_pause()
+#else
+#	define spin_pause() ((void)0)
+#endif
+
+// sleeping on the value of a 32 bit atomic (futex on linux, WaitOnAddress on windows 8+); wakeups may be spurious,
+// so callers check the value again after every wait
+class futex
+{
+public:
+	futex() = delete;
+
+	// returns at once if word no longer holds expected; timeout_ms < 0 waits without a limit
+	static void wait(const std::atomic<uint32_t> & word, const uint32_t expected, const int timeout_ms = -1);
+	static void wake_one(const std::atomic<uint32_t> & word);
+	static void wake_all(const std::atomic<uint32_t> & word);
+};
+
+#endif // !_FUTEX_H_
@@ -0,0 +1,156 @@
+#ifndef _HISTOGRAM_H_
+#define _HISTOGRAM_H_
+
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#	include <intrin.h>
+#endif
+
+// log-linear (HDR style) histogram: 2^sub_bits linear sub-buckets per power of two, ~0.8% relative error
+class histogram_sample_t
+{
+public:
+	static constexpr unsigned sub_bits{ 7 };
+	static constexpr unsigned sub_count{ 1u << sub_bits };
+	static constexpr unsigned max_bits{ 40 }; // ~1100 s in nanoseconds
+	static constexpr unsigned bucket_count{ (max_bits - sub_bits + 2) * sub_count };
+
+	histogram_sample_t() : counts(bucket_count, 0) { }
+
+	static inline unsigned bucket_of(uint64_t value)
+	{
+		if (value >= (1ull << max_bits))
+			value = (1ull << max_bits) - 1;
+
+		if (value < 2 * sub_count)
+			return (unsigned)value;
+
+		const unsigned msb{ 63u - (unsigned)clz64(value) };
+		const unsigned shift{ msb - sub_bits };
+
+		return (shift + 1) * sub_count + (unsigned)((value >> shift) - sub_count);
+	}
+
+	// highest value that falls into bucket
+	static inline uint64_t value_of(const unsigned bucket)
+	{
+		if (bucket < 2 * sub_count)
+			return bucket;
+
+		const unsigned shift{ bucket / sub_count - 1 };
+		const uint64_t sub{ bucket % sub_count + sub_count };
+
+		return ((sub + 1) << shift) - 1;
+	}
+
+	inline uint64_t count() const { return total; }
+
+	// value at quantile q (0..1), 0 if empty
+	uint64_t quantile(const double q) const
+	{
+		if (total == 0)
+			return 0;
+
+		uint64_t rank{ (uint64_t)(q * total + 0.5) };
+		if (rank < 1)
+			rank = 1;
+
+		uint64_t seen{ 0 };
+		for (unsigned bucket = 0; bucket < bucket_count; ++bucket)
+		{
+			seen += counts[bucket];
+			if (seen >= rank)
+				return value_of(bucket);
+		}
+
+		return max_value();
+	}
+
+	uint64_t max_value() const
+	{
+		for (unsigned bucket = bucket_count; bucket-- > 0; )
+		{
+			if (counts[bucket] != 0)
+				return value_of(bucket);
+		}
+
+		return 0;
+	}
+
+	histogram_sample_t & operator+=(const histogram_sample_t & other)
+	{
+		for (unsigned bucket = 0; bucket < bucket_count; ++bucket)
+			counts[bucket] += other.counts[bucket];
+
+		total += other.total;
+
+		return *this;
+	}
+
+	histogram_sample_t operator-(const histogram_sample_t & other) const
+	{
+		histogram_sample_t delta;
+		for (unsigned bucket = 0; bucket < bucket_count; ++bucket)
+			delta.counts[bucket] = counts[bucket] - other.counts[bucket];
+
+		delta.total = total - other.total;
+
+		return delta;
+	}
+
+	std::vector<uint64_t> counts;
+	uint64_t total{ 0 };
+
+private:
+	static inline int clz64(const uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return 63 - (int)index;
+#else
+		return __builtin_clzll(value);
+#endif
+	}
+};
+
+// single writer histogram that a reporter thread may sample at any time without locking
+class histogram_t
+{
+public:
+	histogram_t() : counts(histogram_sample_t::bucket_count) { }
+
+	histogram_t(const histogram_t&) = delete;
+	histogram_t& operator=(const histogram_t&) = delete;
+
+	inline void record(const uint64_t value)
+	{
+		std::atomic<uint64_t> & counter = counts[histogram_sample_t::bucket_of(value)];
+
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		if (value > max.load(std::memory_order_relaxed))
+			max.store(value, std::memory_order_relaxed);
+	}
+
+	void sample(histogram_sample_t & snapshot) const
+	{
+		snapshot.total = 0;
+		for (unsigned bucket = 0; bucket < histogram_sample_t::bucket_count; ++bucket)
+		{
+			snapshot.counts[bucket] = counts[bucket].load(std::memory_order_relaxed);
+			snapshot.total += snapshot.counts[bucket];
+		}
+	}
+
+	inline uint64_t max_value() const { return max.load(std::memory_order_relaxed); }
+
+private:
+	std::vector<std::atomic<uint64_t>> counts;
+	std::atomic<uint64_t> max{ 0 };
+};
+
+#endif // !_HISTOGRAM_H_
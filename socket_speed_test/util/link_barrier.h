@@ -0,0 +1,157 @@
+#ifndef _LINK_BARRIER_H_
+#define _LINK_BARRIER_H_
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdint.h>
+
+#include "futex.h"
+
+#define BARRIER_SPINS_PER_YIELD 1024 // spinners give up their core now and then when threads outnumber cores
+
+// releases every link thread at once: waiters sleep on a futex until the barrier is armed and spin on
+// its state from then on, so opening it costs one cache line transfer per core instead of a mutex hand-off
+// per thread; arm it right before the open, once every link reached wait(). a single core has nobody
+// to spin for, there the waiters keep sleeping until the open wakes them all with one futex call
+class start_barrier_t
+{
+public:
+	start_barrier_t() = default;
+	start_barrier_t(const start_barrier_t&) = delete;
+	start_barrier_t& operator=(const start_barrier_t&) = delete;
+
+	inline void reset()
+	{
+		open_ns_.store(0, std::memory_order_relaxed);
+		state.store(closed, std::memory_order_release);
+	}
+
+	inline void arm()
+	{
+		uint32_t expected{ closed };
+		if (state.compare_exchange_strong(expected, armed, std::memory_order_acq_rel))
+			futex::wake_all(state);
+	}
+
+	inline void open()
+	{
+		open_ns_.store(now(), std::memory_order_relaxed);
+		state.store(opened, std::memory_order_release);
+
+		futex::wake_all(state);
+	}
+
+	inline void wait() const
+	{
+		static const bool spin{ std::thread::hardware_concurrency() > 1 };
+
+		uint32_t current;
+		for (uint32_t spins = 1; (current = state.load(std::memory_order_acquire)) != opened; ++spins)
+		{
+			if ((current == closed) || !spin)
+				futex::wait(state, current);
+			else if (spins % BARRIER_SPINS_PER_YIELD == 0)
+				std::this_thread::yield();
+			else
+				spin_pause();
+		}
+	}
+
+	inline bool is_open() const { return state.load(std::memory_order_acquire) == opened; }
+
+	// steady clock ns of the last open(), 0 while closed
+	inline int64_t open_ns() const { return open_ns_.load(std::memory_order_relaxed); }
+
+	static inline int64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+private:
+	enum : uint32_t
+	{
+		closed = 0,
+		armed,
+		opened
+	};
+
+	std::atomic<uint32_t> state{ closed };
+	std::atomic<int64_t> open_ns_{ 0 };
+};
+
+// counts link threads out as they leave: each one holds a scope_t for its lifetime, the stopping thread
+// waits until the last scope ended and reads when the first and the last one did
+class stop_barrier_t
+{
+public:
+	stop_barrier_t() = default;
+	stop_barrier_t(const stop_barrier_t&) = delete;
+	stop_barrier_t& operator=(const stop_barrier_t&) = delete;
+
+	class scope_t
+	{
+	public:
+		scope_t(stop_barrier_t & _barrier) : barrier(_barrier) { barrier.enter(); }
+		scope_t(const scope_t&) = delete;
+		scope_t& operator=(const scope_t&) = delete;
+		~scope_t() { barrier.leave(); }
+
+	private:
+		stop_barrier_t & barrier;
+	};
+
+	inline void reset()
+	{
+		running.store(0, std::memory_order_relaxed);
+		first_ns_.store(0, std::memory_order_relaxed);
+		last_ns_.store(0, std::memory_order_relaxed);
+	}
+
+	// true once no scope is left, false on timeout
+	inline bool wait_for(const int timeout_ms) const
+	{
+		const int64_t give_up_ns{ start_barrier_t::now() + timeout_ms * 1000000ll };
+
+		uint32_t current;
+		while ((current = running.load(std::memory_order_acquire)) != 0)
+		{
+			const int64_t left_ns{ give_up_ns - start_barrier_t::now() };
+			if (left_ns <= 0)
+				return false;
+
+			futex::wait(running, current, (int)((left_ns + 999999) / 1000000));
+		}
+
+		return true;
+	}
+
+	inline int64_t first_ns() const { return first_ns_.load(std::memory_order_relaxed); }
+	inline int64_t last_ns() const { return last_ns_.load(std::memory_order_relaxed); }
+
+private:
+	inline void enter()
+	{
+		running.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	inline void leave()
+	{
+		const int64_t now{ start_barrier_t::now() };
+
+		int64_t first{ 0 };
+		first_ns_.compare_exchange_strong(first, now, std::memory_order_relaxed);
+
+		int64_t last{ last_ns_.load(std::memory_order_relaxed) };
+		while ((now > last) && !last_ns_.compare_exchange_weak(last, now, std::memory_order_relaxed));
+
+		if (running.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			futex::wake_all(running);
+	}
+
+	std::atomic<uint32_t> running{ 0 };
+	std::atomic<int64_t> first_ns_{ 0 };
+	std::atomic<int64_t> last_ns_{ 0 };
+};
+
+#endif // !_LINK_BARRIER_H_
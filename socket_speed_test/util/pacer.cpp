@@ -0,0 +1,37 @@
+#include <chrono>
+#include <thread>
+
+#include "pacer.h"
+#include "futex.h"
+
+// vdso clock_gettime on linux, a tsc read without a syscall
+static inline int64_t clock_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void pacer_t::start(const double bytes_per_s, const int64_t _spin_ns, const std::size_t burst_bytes)
+{
+	ns_per_byte = bytes_per_s > 0. ? 1e9 / bytes_per_s : 0.;
+	spin_ns = _spin_ns > 0 ? _spin_ns : 0;
+	burst_ns = burst_bytes * ns_per_byte;
+	due_ns = (double)clock_ns();
+}
+
+void pacer_t::wait_due(const std::size_t bytes)
+{
+	int64_t now{ clock_ns() };
+
+	// idle time is not saved up: a stalled sender would otherwise send everything it missed back to back
+	if (now - due_ns > burst_ns)
+		due_ns = now - burst_ns;
+
+	const int64_t due{ (int64_t)due_ns };
+	if (due - now > spin_ns)
+		std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - spin_ns));
+
+	while (clock_ns() < due)
+		spin_pause();
+
+	due_ns += bytes * ns_per_byte;
+}
@@ -0,0 +1,38 @@
+#ifndef _PACER_H_
+#define _PACER_H_
+
+#include <cstddef>
+#include <stdint.h>
+
+// token bucket pacing of one sender thread on the steady clock: every send waits until the bytes before it
+// went out at the target rate; gaps longer than spin_ns sleep and busy wait only their last spin_ns,
+// as a sleep alone overshoots by the timer slack (~50 us on linux)
+class pacer_t
+{
+public:
+	pacer_t() = default;
+	pacer_t(const pacer_t&) = delete;
+	pacer_t& operator=(const pacer_t&) = delete;
+
+	// bytes_per_s = 0 disables pacing; a sender that fell behind catches up by at most burst_bytes
+	void start(const double bytes_per_s, const int64_t spin_ns, const std::size_t burst_bytes);
+
+	// blocks until the next bytes are due
+	inline void wait(const std::size_t bytes)
+	{
+		if (ns_per_byte > 0.)
+			wait_due(bytes);
+	}
+
+	inline bool enabled() const { return ns_per_byte > 0.; }
+
+private:
+	void wait_due(const std::size_t bytes);
+
+	double ns_per_byte{ 0. };
+	double due_ns{ 0. }; // fractional, so the rate does not drift with packet lengths that do not divide evenly
+	int64_t spin_ns{ 0 };
+	double burst_ns{ 0. };
+};
+
+#endif // !_PACER_H_
@@ -0,0 +1,109 @@
+#include <cassert>
+#include <errno.h>
+
+#include "poller.h"
+
+#ifdef __linux__
+
+#	include <sys/epoll.h>
+#	include <unistd.h>
+
+#	define MAX_EVENTS_PER_WAIT 256
+
+bool poller_t::is_supported()
+{
+	return true;
+}
+
+int poller_t::create()
+{
+	if ((poller_id = epoll_create1(0)) == -1)
+	{
+		int error_code = errno;
+		poller_id = 0;
+
+		return error_code;
+	}
+
+	return 0;
+}
+
+int poller_t::add(const socket_t & link, const uint64_t key)
+{
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u64 = key;
+
+	if (epoll_ctl(poller_id, EPOLL_CTL_ADD, link.socket_id, &event) == -1)
+		return errno;
+
+	return 0;
+}
+
+int poller_t::wait(uint64_t * keys, const int capacity, const int timeout_ms, int & ready_count)
+{
+	assert(capacity > 0);
+
+	epoll_event events[MAX_EVENTS_PER_WAIT];
+	const int && ret = epoll_wait(poller_id, events, capacity < MAX_EVENTS_PER_WAIT ? capacity : MAX_EVENTS_PER_WAIT, timeout_ms);
+	if (ret == -1)
+	{
+		ready_count = 0;
+
+		return errno == EINTR ? 0 : errno;
+	}
+
+	for (int i = 0; i < ret; ++i)
+		keys[i] = events[i].data.u64;
+
+	ready_count = ret;
+
+	return 0;
+}
+
+int poller_t::close()
+{
+	if (poller_id != 0)
+	{
+		::close(poller_id);
+		poller_id = 0;
+	}
+
+	return 0;
+}
+
+#else
+
+bool poller_t::is_supported()
+{
+	return false;
+}
+
+int poller_t::create()
+{
+	return -1;
+}
+
+int poller_t::add(const socket_t &, const uint64_t)
+{
+	return -1;
+}
+
+int poller_t::wait(uint64_t *, const int, const int, int & ready_count)
+{
+	ready_count = 0;
+
+	return -1;
+}
+
+int poller_t::close()
+{
+	return 0;
+}
+
+#endif // __linux__
+
+poller_t::~poller_t()
+{
+	close();
+}
@@ -0,0 +1,27 @@
+#ifndef _POLLER_H_
+#define _POLLER_H_
+
+#include <stdint.h>
+
+#include "sockio.h"
+
+// readiness multiplexer over many socket_t links (epoll on linux)
+class poller_t
+{
+public:
+	static bool is_supported();
+
+	int create();
+	int add(const socket_t & link, const uint64_t key);
+
+	// waits up to timeout_ms for readable links and fills keys with the registered key of each
+	int wait(uint64_t * keys, const int capacity, const int timeout_ms, int & ready_count);
+
+	int close();
+	~poller_t();
+
+private:
+	int poller_id{ 0 };
+};
+
+#endif // !_POLLER_H_
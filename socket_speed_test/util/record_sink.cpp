@@ -0,0 +1,92 @@
+#ifdef _MSC_VER
+#   define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#include <errno.h>
+
+#include "record_sink.h"
+
+#define RECORD_BUFFER_RESERVE (64 * 1024)
+
+int record_sink_t::open(const std::string & path, const std::string & header)
+{
+	close();
+
+	file = fopen(path.c_str(), "w");
+	if (file == nullptr)
+		return errno != 0 ? errno : -1;
+
+	pending.reserve(RECORD_BUFFER_RESERVE);
+	if (!header.empty())
+		pending.append(header).push_back('\n');
+
+	stop = false;
+	writer = std::thread(&record_sink_t::writer_core, this);
+
+	return 0;
+}
+
+void record_sink_t::write(const std::string & line)
+{
+	if (file == nullptr)
+		return;
+
+	std::lock_guard<std::mutex> lock(guard);
+
+	const bool was_empty{ pending.empty() };
+	pending.append(line).push_back('\n');
+
+	if (was_empty)
+		cv.notify_one();
+}
+
+void record_sink_t::writer_core()
+{
+	std::string writing;
+	writing.reserve(RECORD_BUFFER_RESERVE);
+
+	std::unique_lock<std::mutex> lock(guard);
+	while (true)
+	{
+		while (pending.empty() && !stop)
+			cv.wait(lock);
+
+		if (pending.empty() && stop)
+			break;
+
+		// swap the buffers and write outside of the lock
+		writing.swap(pending);
+		lock.unlock();
+
+		fwrite(writing.data(), 1, writing.size(), file);
+		fflush(file);
+		writing.clear();
+
+		lock.lock();
+	}
+}
+
+int record_sink_t::close()
+{
+	if (file == nullptr)
+		return 0;
+
+	{
+		std::lock_guard<std::mutex> lock(guard);
+		stop = true;
+		cv.notify_one();
+	}
+
+	if (writer.joinable())
+		writer.join();
+
+	const int ret = fclose(file);
+	file = nullptr;
+
+	return ret;
+}
+
+record_sink_t::~record_sink_t()
+{
+	close();
+}
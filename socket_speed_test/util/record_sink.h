@@ -0,0 +1,43 @@
+#ifndef _RECORD_SINK_H_
+#define _RECORD_SINK_H_
+
+#include <string>
+#include <mutex>
+#include <thread>
+#include <stdio.h>
+#include <condition_variable>
+
+// line oriented file writer; lines are appended to a memory buffer and a writer thread does the file io,
+// so the caller never blocks on the disk
+class record_sink_t
+{
+public:
+	record_sink_t() = default;
+	record_sink_t(const record_sink_t&) = delete;
+	record_sink_t& operator=(const record_sink_t&) = delete;
+
+	// truncates path and writes header (if not empty) as its first line
+	int open(const std::string & path, const std::string & header = "");
+
+	// appends line and a newline
+	void write(const std::string & line);
+
+	inline bool is_open() const { return file != nullptr; }
+
+	// writes everything buffered so far and closes the file
+	int close();
+	~record_sink_t();
+
+private:
+	void writer_core();
+
+	FILE * file{ nullptr };
+	std::thread writer;
+
+	std::mutex guard;
+	std::condition_variable cv;
+	std::string pending; // guarded
+	bool stop{ false }; // guarded
+};
+
+#endif // !_RECORD_SINK_H_
@@ -1,162 +1,197 @@
 #ifndef _RESETTABLE_EVENT_H_
 #define _RESETTABLE_EVENT_H_
 
-#include <mutex>
 #include <atomic>
-#include <type_traits>
-#include <condition_variable>
+#include <chrono>
+#include <thread>
+#include <climits>
+#include <algorithm>
+#include <stdint.h>
 
-template<bool _AutoReset>
-class resettable_event;
+#include "futex.h"
 
-template<>
-class resettable_event<true> // Auto Reset
+#define EVENT_SPINS 128 // pauses a waiter spends watching the state before it goes to sleep, a few microseconds
+
+// the state and the count of sleeping waiters; set() is one exchange and a load while nobody sleeps, a waiter
+// spins shortly on the state before it registers itself and sleeps on the futex
+class resettable_event_base
 {
 public:
-	typedef resettable_event<true> type;
-	static constexpr bool is_auto{ true };
+	resettable_event_base(const resettable_event_base&) = delete;
+	resettable_event_base& operator=(const resettable_event_base&) = delete;
 
-	resettable_event(const resettable_event&) = delete;
-	resettable_event& operator=(const resettable_event&) = delete;
+	inline bool is_set() const
+	{
+		return state.load(std::memory_order_acquire) != 0;
+	}
 
-	resettable_event(const bool initial_state = false) :
-		state{ initial_state }
+	inline void reset()
+	{
+		state.store(0, std::memory_order_release);
+	}
+
+protected:
+	resettable_event_base(const bool initial_state) :
+		state{ initial_state ? 1u : 0u }
 	{ }
 
-	inline bool is_set() const
+	// true if this set() changed the state and someone may sleep on it; the exchange and the load are both
+	// sequentially consistent, so either set() sees the waiter or the waiter's futex call sees the state
+	inline bool raise()
 	{
-		return state.load();
+		return (state.exchange(1) == 0) && (waiters.load() != 0);
 	}
 
-	inline void set()
+	// true once the state is set, false after EVENT_SPINS pauses; a single core has nobody to spin for
+	inline bool spin() const
 	{
-		std::lock_guard<std::mutex> lock(guard);
+		static const bool multi_core{ std::thread::hardware_concurrency() > 1 };
 
-		if (!state.exchange(true))
-			cv.notify_all();
+		if (multi_core)
+		{
+			for (int i = 0; i < EVENT_SPINS; ++i)
+			{
+				if (state.load(std::memory_order_relaxed) != 0)
+					return true;
+
+				spin_pause();
+			}
+		}
+
+		return false;
 	}
 
-	inline void reset()
+	inline void sleep(const int timeout_ms) const
 	{
-		std::lock_guard<std::mutex> lock(guard);
-		state = false;
+		waiters.fetch_add(1);
+		futex::wait(state, 0, timeout_ms);
+		waiters.fetch_sub(1, std::memory_order_relaxed);
 	}
 
-	inline void wait()
+	// whole ms left until timeout_time, rounded up; 0 once it passed
+	template<class _Clock, class _Duration>
+	static inline int ms_left(const std::chrono::time_point<_Clock, _Duration> & timeout_time)
 	{
-		std::unique_lock<std::mutex> lock(guard);
+		const long long left_us{ std::chrono::duration_cast<std::chrono::microseconds>(timeout_time - _Clock::now()).count() };
 
-		while (!state.exchange(false))
-			cv.wait(lock);
+		return left_us > 0 ? (int)std::min((left_us + 999) / 1000, (long long)INT_MAX) : 0;
 	}
 
-	template<class _Rep, class _Period>
-	inline bool wait_for(const std::chrono::duration<_Rep, _Period> & rel_time)
+	std::atomic<uint32_t> state;
+	mutable std::atomic<uint32_t> waiters{ 0 };
+};
+
+template<bool _AutoReset>
+class resettable_event;
+
+template<>
+class resettable_event<true> : public resettable_event_base // Auto Reset
+{
+public:
+	typedef resettable_event<true> type;
+	static constexpr bool is_auto{ true };
+
+	resettable_event(const bool initial_state = false) :
+		resettable_event_base{ initial_state }
+	{ }
+
+	// only one waiter can take the state, so only one is woken
+	inline void set()
 	{
-		std::unique_lock<std::mutex> lock(guard);
+		if (raise())
+			futex::wake_one(state);
+	}
 
-		while (!state.exchange(false))
+	inline void wait()
+	{
+		while (!take())
 		{
-			if (cv.wait_for(lock, rel_time) == std::cv_status::timeout)
-				return state.exchange(false);
+			if (!spin())
+				sleep(-1);
 		}
+	}
 
-		return true;
+	template<class _Rep, class _Period>
+	inline bool wait_for(const std::chrono::duration<_Rep, _Period> & rel_time)
+	{
+		return wait_until(std::chrono::steady_clock::now() + rel_time);
 	}
 
 	template<class _Clock, class _Duration>
 	inline bool wait_until(const std::chrono::time_point<_Clock, _Duration> & timeout_time)
 	{
-		std::unique_lock<std::mutex> lock(guard);
-
-		while (!state.exchange(false))
+		while (!take())
 		{
-			if (cv.wait_until(lock, timeout_time) == std::cv_status::timeout)
-				return state.exchange(false);
+			if (spin())
+				continue;
+
+			const int timeout_ms{ ms_left(timeout_time) };
+			if (timeout_ms == 0)
+				return take();
+
+			sleep(timeout_ms);
 		}
 
 		return true;
 	}
 
-protected:
-	std::atomic_bool state;
-	mutable std::mutex guard;
-	mutable std::condition_variable cv;
+private:
+	// resets the state if it was set, the load keeps failed attempts from bouncing the cache line
+	inline bool take()
+	{
+		return (state.load(std::memory_order_relaxed) != 0) && (state.exchange(0, std::memory_order_acquire) != 0);
+	}
 };
 
 template<>
-class resettable_event<false> // Manual Reset
+class resettable_event<false> : public resettable_event_base // Manual Reset
 {
 public:
 	typedef resettable_event<false> type;
 	static constexpr bool is_auto{ false };
 
-	resettable_event(const resettable_event&) = delete;
-	resettable_event& operator=(const resettable_event&) = delete;
-
 	resettable_event(const bool initial_state = false) :
-		state{ initial_state }
+		resettable_event_base{ initial_state }
 	{ }
 
-	inline bool is_set() const
-	{
-		return state.load();
-	}
-
 	inline void set()
 	{
-		std::lock_guard<std::mutex> lock(guard);
-
-		if (!state.exchange(true))
-			cv.notify_all();
-	}
-
-	inline void reset()
-	{
-		std::lock_guard<std::mutex> lock(guard);
-		state = false;
+		if (raise())
+			futex::wake_all(state);
 	}
 
 	inline void wait() const
 	{
-		std::unique_lock<std::mutex> lock(guard);
-
-		while (!state.load())
-			cv.wait(lock);
+		while (!is_set())
+		{
+			if (!spin())
+				sleep(-1);
+		}
 	}
 
 	template<class _Rep, class _Period>
-	inline bool wait_for(const std::chrono::duration<_Rep, _Period> & rel_time)  const
+	inline bool wait_for(const std::chrono::duration<_Rep, _Period> & rel_time) const
 	{
-		std::unique_lock<std::mutex> lock(guard);
-
-		while (!state.load())
-		{
-			if (cv.wait_for(lock, rel_time) == std::cv_status::timeout)
-				return state.load();
-		}
-
-		return true;
+		return wait_until(std::chrono::steady_clock::now() + rel_time);
 	}
 
 	template<class _Clock, class _Duration>
-	inline bool wait_until(const std::chrono::time_point<_Clock, _Duration> & timeout_time)  const
+	inline bool wait_until(const std::chrono::time_point<_Clock, _Duration> & timeout_time) const
 	{
-		std::unique_lock<std::mutex> lock(guard);
-
-		while (!state.load())
+		while (!is_set())
 		{
-			if (cv.wait_until(lock, timeout_time) == std::cv_status::timeout)
-				return state.load();
+			if (spin())
+				continue;
+
+			const int timeout_ms{ ms_left(timeout_time) };
+			if (timeout_ms == 0)
+				return is_set();
+
+			sleep(timeout_ms);
 		}
 
 		return true;
 	}
-
-protected:
-	std::atomic_bool state;
-	mutable std::mutex guard;
-	mutable std::condition_variable cv;
 };
 
 #endif // !_RESETTABLE_EVENT_H_
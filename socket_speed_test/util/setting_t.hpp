@@ -292,7 +292,7 @@ public:
 		vector_.resize(_size);
 		for (std::size_t i = 0; i < _size; ++i)
 		{
-			sprintf(buf, "%s[%2llu]", label().c_str(), i + 1);
+			sprintf(buf, "%s[%2llu]", label().c_str(), (unsigned long long)i + 1);
 			vector_[i].label() = buf;
 		}
 	}
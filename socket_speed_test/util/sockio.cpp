@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdexcept>
+#include <string.h>
 
 #include "sockio.h"
 
@@ -17,13 +18,20 @@
 #	include <netdb.h>
 #	include <sys/types.h>
 #	include <unistd.h>
+#	include <fcntl.h>
 #	include <errno.h>
+#	include <poll.h>
+#	include <linux/errqueue.h>
+#	include <netinet/tcp.h>
 
 #	define INVALID_SOCKET   (SOCKET)(~0)
 #	define SOCKET_ERROR     (-1)
 #	define ADDRESS_LEN_T unsigned int
+#	define MAX_BATCH_CHUNK 64
 #	define get_last_error() errno
 #	define close_socket(socket_id) ::close(socket_id)
+#	define would_block(error_code) ((error_code) == EAGAIN || (error_code) == EWOULDBLOCK)
+#	define SEND_FLAGS MSG_NOSIGNAL // a closed peer fails the send with EPIPE instead of killing the process
 
 #else
 
@@ -34,6 +42,8 @@
 #	define ADDRESS_LEN_T int
 #	define get_last_error() WSAGetLastError()
 #	define close_socket(socket_id) ::closesocket(socket_id)
+#	define would_block(error_code) ((error_code) == WSAEWOULDBLOCK)
+#	define SEND_FLAGS 0
 
 struct winsock_initializer_t
 {
@@ -59,7 +69,61 @@ public:
 
 #endif
 
-int socket_t::create(const ip_protocol_t protocol, const std::string & ip, const uint16_t port)
+static int set_int_option(const SOCKET socket_id, const int level, const int name, const int value)
+{
+	if (setsockopt(socket_id, level, name, (const char*)&value, sizeof(value)) == SOCKET_ERROR)
+		return get_last_error();
+
+	return 0;
+}
+
+static int get_int_option(const SOCKET socket_id, const int level, const int name, int & value)
+{
+	ADDRESS_LEN_T value_len = sizeof(value);
+	value = 0;
+
+	if (getsockopt(socket_id, level, name, (char*)&value, &value_len) == SOCKET_ERROR)
+		return get_last_error();
+
+	return 0;
+}
+
+static int apply_options(const SOCKET socket_id, const bool is_tcp, const socket_options_t & options)
+{
+	int ret{ 0 };
+
+	if ((ret == 0) && (options.send_buffer > 0))
+		ret = set_int_option(socket_id, SOL_SOCKET, SO_SNDBUF, options.send_buffer);
+	if ((ret == 0) && (options.recv_buffer > 0))
+		ret = set_int_option(socket_id, SOL_SOCKET, SO_RCVBUF, options.recv_buffer);
+	if ((ret == 0) && is_tcp && options.tcp_no_delay)
+		ret = set_int_option(socket_id, IPPROTO_TCP, TCP_NODELAY, 1);
+
+#ifdef __linux__
+	if ((ret == 0) && options.reuse_port)
+		ret = set_int_option(socket_id, SOL_SOCKET, SO_REUSEPORT, 1);
+	if ((ret == 0) && (options.busy_poll_us > 0))
+		ret = set_int_option(socket_id, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us);
+	if ((ret == 0) && is_tcp && options.tcp_cork)
+		ret = set_int_option(socket_id, IPPROTO_TCP, TCP_CORK, 1);
+	if ((ret == 0) && is_tcp && (options.tcp_notsent_lowat > 0))
+		ret = set_int_option(socket_id, IPPROTO_TCP, TCP_NOTSENT_LOWAT, options.tcp_notsent_lowat);
+	if ((ret == 0) && is_tcp && !options.tcp_congestion.empty())
+	{
+		if (setsockopt(socket_id, IPPROTO_TCP, TCP_CONGESTION, options.tcp_congestion.c_str(), (socklen_t)options.tcp_congestion.size()) == SOCKET_ERROR)
+			ret = get_last_error();
+	}
+#else
+	// no SO_REUSEPORT, SO_BUSY_POLL, TCP_CORK, TCP_NOTSENT_LOWAT or TCP_CONGESTION on winsock
+	if ((ret == 0) && (options.reuse_port || (options.busy_poll_us > 0) ||
+		(is_tcp && (options.tcp_cork || (options.tcp_notsent_lowat > 0) || !options.tcp_congestion.empty()))))
+		ret = WSAEOPNOTSUPP;
+#endif
+
+	return ret;
+}
+
+int socket_t::create(const ip_protocol_t protocol, const std::string & ip, const uint16_t port, const socket_options_t & options)
 {
 	//Create a socket
 	if ((socket_id = ::socket(AF_INET, protocol == ip_protocol_t::tcp ? SOCK_STREAM : SOCK_DGRAM, (int)protocol)) == INVALID_SOCKET)
@@ -69,6 +133,15 @@ int socket_t::create(const ip_protocol_t protocol, const std::string & ip, const
 		return error_code;
 	}
 
+	//Apply options
+	int ret = apply_options(socket_id, protocol == ip_protocol_t::tcp, options);
+	if (ret != 0)
+	{
+		close();
+
+		return ret;
+	}
+
 	//Prepare the sockaddr_in structure
 	sockaddr_in address;
 	address.sin_family = AF_INET;
@@ -117,7 +190,8 @@ int socket_t::send(const char * packet, const int size)
 
 	do
 	{
-		const int && ret = ::send(socket_id, offset, to_send, 0);
+		const int && ret = ::send(socket_id, offset, to_send, SEND_FLAGS);
+		count_syscall(true);
 		if (ret == SOCKET_ERROR)
 		{
 			int error_code = get_last_error();
@@ -149,7 +223,8 @@ int socket_t::send_to(const std::string & pair_ip, const uint16_t pair_port, con
 
 	do
 	{
-		const int && ret = ::sendto(socket_id, offset, to_send, 0, (sockaddr*)&address, sizeof(address));
+		const int && ret = ::sendto(socket_id, offset, to_send, SEND_FLAGS, (sockaddr*)&address, sizeof(address));
+		count_syscall(true);
 		if (ret == SOCKET_ERROR)
 		{
 			int error_code = get_last_error();
@@ -173,6 +248,7 @@ int socket_t::recv(char * packet, const int size)
 	do
 	{
 		const int && ret = ::recv(socket_id, offset, to_receive, 0);
+		count_syscall(false);
 		if (ret == 0) // connection closed
 		{
 			close();
@@ -198,6 +274,7 @@ int socket_t::recv(char * packet, const int size)
 int socket_t::recv_any(char * packet, const int capacity, int & recvd_size)
 {
 	const int && ret = ::recv(socket_id, packet, capacity, 0);
+	count_syscall(false);
 	if (ret == 0) // connection closed
 	{
 		close();
@@ -229,6 +306,7 @@ int socket_t::recv_from(char * packet, const int size, std::string & pair_ip, ui
 	do
 	{
 		const int && ret = ::recvfrom(socket_id, offset, to_receive, 0, (sockaddr*)&address, &address_len);
+		count_syscall(false);
 		if (ret == 0) // connection closed
 		{
 			close();
@@ -259,6 +337,7 @@ int socket_t::recv_any_from(char * packet, const int capacity, int & recvd_size,
 	sockaddr_in address;
 	ADDRESS_LEN_T address_len = sizeof(address);
 	const int && ret = ::recvfrom(socket_id, packet, capacity, 0, (sockaddr*)&address, &address_len);
+	count_syscall(false);
 	if (ret == 0) // connection closed
 	{
 		close();
@@ -281,6 +360,345 @@ int socket_t::recv_any_from(char * packet, const int capacity, int & recvd_size,
 	return 0;
 }
 
+int socket_t::send_batch(char * const * packets, const int size, const int count)
+{
+#ifdef __linux__
+	mmsghdr messages[MAX_BATCH_CHUNK];
+	iovec iov[MAX_BATCH_CHUNK];
+	int done{ 0 };
+
+	while (done < count)
+	{
+		const int chunk{ count - done < MAX_BATCH_CHUNK ? count - done : MAX_BATCH_CHUNK };
+
+		memset(messages, 0, sizeof(mmsghdr) * chunk);
+		for (int i = 0; i < chunk; ++i)
+		{
+			iov[i].iov_base = packets[done + i];
+			iov[i].iov_len = size;
+			messages[i].msg_hdr.msg_iov = &iov[i];
+			messages[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int && ret = ::sendmmsg(socket_id, messages, chunk, SEND_FLAGS);
+		count_syscall(true);
+
+		if (ret == SOCKET_ERROR)
+		{
+			int error_code = get_last_error();
+			close();
+
+			return error_code;
+		}
+
+		done += ret;
+	}
+
+	return 0;
+#else
+	for (int i = 0; i < count; ++i)
+	{
+		int ret = send(packets[i], size);
+		if (ret != 0)
+			return ret;
+	}
+
+	return 0;
+#endif
+}
+
+int socket_t::recv_batch(char * const * packets, const int capacity, const int count, int * recvd_sizes, int & recvd_count)
+{
+#ifdef __linux__
+	mmsghdr messages[MAX_BATCH_CHUNK];
+	iovec iov[MAX_BATCH_CHUNK];
+	const int chunk{ count < MAX_BATCH_CHUNK ? count : MAX_BATCH_CHUNK };
+
+	memset(messages, 0, sizeof(mmsghdr) * chunk);
+	for (int i = 0; i < chunk; ++i)
+	{
+		iov[i].iov_base = packets[i];
+		iov[i].iov_len = capacity;
+		messages[i].msg_hdr.msg_iov = &iov[i];
+		messages[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	// block for the first datagram only, then take whatever else is already queued
+	const int && ret = ::recvmmsg(socket_id, messages, chunk, MSG_WAITFORONE, nullptr);
+	count_syscall(false);
+
+	if (ret == SOCKET_ERROR)
+	{
+		int error_code = get_last_error();
+		close();
+
+		return error_code;
+	}
+
+	for (int i = 0; i < ret; ++i)
+		recvd_sizes[i] = (int)messages[i].msg_len;
+
+	recvd_count = ret;
+
+	return 0;
+#else
+	(void)count;
+
+	int ret = recv_any(packets[0], capacity, recvd_sizes[0]);
+	recvd_count = (ret == 0 ? 1 : 0);
+
+	return ret;
+#endif
+}
+
+int socket_t::try_recv(char * packet, const int capacity, int & recvd_size)
+{
+	const int && ret = ::recv(socket_id, packet, capacity, 0);
+	count_syscall(false);
+	if (ret == 0) // connection closed
+	{
+		close();
+
+		return -1;
+	}
+
+	if (ret == SOCKET_ERROR)
+	{
+		int error_code = get_last_error();
+		if (would_block(error_code))
+		{
+			recvd_size = 0;
+
+			return 0;
+		}
+
+		close();
+
+		return error_code;
+	}
+
+	recvd_size = ret;
+
+	return 0;
+}
+
+int socket_t::set_blocking(const bool blocking)
+{
+#ifdef __linux__
+	int flags = fcntl(socket_id, F_GETFL, 0);
+	if (flags == SOCKET_ERROR)
+		return get_last_error();
+
+	flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+	if (fcntl(socket_id, F_SETFL, flags) == SOCKET_ERROR)
+		return get_last_error();
+#else
+	u_long mode = blocking ? 0 : 1;
+	if (ioctlsocket(socket_id, FIONBIO, &mode) == SOCKET_ERROR)
+		return get_last_error();
+#endif
+
+	return 0;
+}
+
+int socket_t::set_recv_timeout(const int timeout_ms)
+{
+#ifdef __linux__
+	timeval timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_usec = (timeout_ms % 1000) * 1000;
+#else
+	DWORD timeout = (DWORD)timeout_ms;
+#endif
+
+	if (setsockopt(socket_id, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout)) == SOCKET_ERROR)
+		return get_last_error();
+
+	return 0;
+}
+
+int socket_t::set_max_pacing_rate(const uint64_t bytes_per_s)
+{
+#if defined(__linux__) && defined(SO_MAX_PACING_RATE)
+	// the option was 32 bits wide before linux 4.20, the wide form is only needed above 4 GB/s
+	int ret;
+	if (bytes_per_s <= 0xffffffffull)
+	{
+		const uint32_t rate{ (uint32_t)bytes_per_s };
+		ret = setsockopt(socket_id, SOL_SOCKET, SO_MAX_PACING_RATE, &rate, sizeof(rate));
+	}
+	else
+		ret = setsockopt(socket_id, SOL_SOCKET, SO_MAX_PACING_RATE, &bytes_per_s, sizeof(bytes_per_s));
+
+	if (ret == SOCKET_ERROR)
+		return get_last_error();
+
+	return 0;
+#else
+	(void)bytes_per_s;
+
+	return -1;
+#endif
+}
+
+bool socket_t::is_zerocopy_supported()
+{
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+	return true;
+#else
+	return false;
+#endif
+}
+
+int socket_t::set_zerocopy(const bool enabled)
+{
+#if defined(__linux__) && defined(SO_ZEROCOPY)
+	const int value{ enabled ? 1 : 0 };
+	if (setsockopt(socket_id, SOL_SOCKET, SO_ZEROCOPY, &value, sizeof(value)) == SOCKET_ERROR)
+		return get_last_error();
+
+	return 0;
+#else
+	(void)enabled;
+
+	return -1;
+#endif
+}
+
+int socket_t::send_zerocopy(const char * packet, const int size, int & sent_size, uint32_t & notification_id)
+{
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+	const int && ret = ::send(socket_id, packet, size, MSG_ZEROCOPY | SEND_FLAGS);
+	count_syscall(true);
+	if (ret == SOCKET_ERROR)
+	{
+		int error_code = get_last_error();
+		if (error_code != ENOBUFS) // optmem limit, completions have to be reaped first
+			close();
+
+		return error_code;
+	}
+
+	sent_size = ret;
+	notification_id = zerocopy_id++;
+
+	return 0;
+#else
+	(void)packet; (void)size; (void)sent_size; (void)notification_id;
+
+	return -1;
+#endif
+}
+
+int socket_t::reap_zerocopy(uint32_t & first_id, uint32_t & last_id, bool & copied, bool & reaped, const int timeout_ms)
+{
+#if defined(__linux__) && defined(MSG_ZEROCOPY)
+	reaped = false;
+
+	pollfd descriptor;
+	descriptor.fd = socket_id;
+	descriptor.events = 0; // POLLERR is always reported
+	descriptor.revents = 0;
+
+	const int && ready = ::poll(&descriptor, 1, timeout_ms);
+	if (ready == SOCKET_ERROR)
+	{
+		int error_code = get_last_error();
+
+		return error_code == EINTR ? 0 : error_code;
+	}
+
+	if ((ready == 0) || !(descriptor.revents & POLLERR))
+		return 0;
+
+	char control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in))];
+	msghdr message;
+	memset(&message, 0, sizeof(message));
+	message.msg_control = control;
+	message.msg_controllen = sizeof(control);
+
+	const int && ret = ::recvmsg(socket_id, &message, MSG_ERRQUEUE);
+	count_syscall(true);
+	if (ret == SOCKET_ERROR)
+	{
+		int error_code = get_last_error();
+
+		return would_block(error_code) ? 0 : error_code;
+	}
+
+	for (cmsghdr * header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header))
+	{
+		if (!(((header->cmsg_level == SOL_IP) && (header->cmsg_type == IP_RECVERR)) ||
+			((header->cmsg_level == SOL_IPV6) && (header->cmsg_type == IPV6_RECVERR))))
+			continue;
+
+		const sock_extended_err * error = (const sock_extended_err*)CMSG_DATA(header);
+		if (error->ee_errno != 0 || error->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+			return error->ee_errno != 0 ? (int)error->ee_errno : -1;
+
+		first_id = error->ee_info;
+		last_id = error->ee_data;
+		copied = (error->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+		reaped = true;
+	}
+
+	return 0;
+#else
+	(void)first_id; (void)last_id; (void)copied; (void)timeout_ms;
+	reaped = false;
+
+	return -1;
+#endif
+}
+
+int socket_t::set_options(const socket_options_t & options)
+{
+	int type{ 0 };
+	int ret = get_int_option(socket_id, SOL_SOCKET, SO_TYPE, type);
+	if (ret != 0)
+		return ret;
+
+	return apply_options(socket_id, type == SOCK_STREAM, options);
+}
+
+int socket_t::get_options(socket_options_t & options) const
+{
+	int type{ 0 }, value{ 0 };
+	int ret = get_int_option(socket_id, SOL_SOCKET, SO_TYPE, type);
+	const bool is_tcp{ type == SOCK_STREAM };
+
+	options = socket_options_t();
+
+	if (ret == 0)
+		ret = get_int_option(socket_id, SOL_SOCKET, SO_SNDBUF, options.send_buffer);
+	if (ret == 0)
+		ret = get_int_option(socket_id, SOL_SOCKET, SO_RCVBUF, options.recv_buffer);
+	if ((ret == 0) && is_tcp && ((ret = get_int_option(socket_id, IPPROTO_TCP, TCP_NODELAY, value)) == 0))
+		options.tcp_no_delay = value != 0;
+
+#ifdef __linux__
+	if ((ret == 0) && ((ret = get_int_option(socket_id, SOL_SOCKET, SO_REUSEPORT, value)) == 0))
+		options.reuse_port = value != 0;
+	if (ret == 0)
+		ret = get_int_option(socket_id, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us);
+	if ((ret == 0) && is_tcp && ((ret = get_int_option(socket_id, IPPROTO_TCP, TCP_CORK, value)) == 0))
+		options.tcp_cork = value != 0;
+	if ((ret == 0) && is_tcp)
+		ret = get_int_option(socket_id, IPPROTO_TCP, TCP_NOTSENT_LOWAT, options.tcp_notsent_lowat);
+	if ((ret == 0) && is_tcp)
+	{
+		char name[32] = { 0 };
+		socklen_t name_len = sizeof(name) - 1;
+		if (getsockopt(socket_id, IPPROTO_TCP, TCP_CONGESTION, name, &name_len) == SOCKET_ERROR)
+			ret = get_last_error();
+		else
+			options.tcp_congestion = name;
+	}
+#endif
+
+	return ret;
+}
+
 std::string socket_t::mine_ip() const
 {
 	sockaddr_in address;
@@ -317,6 +735,21 @@ uint16_t socket_t::pair_port() const
 	return htons(address.sin_port);
 }
 
+int socket_t::shutdown()
+{
+	if (socket_id != (SOCKET)0)
+	{
+#ifdef __linux__
+		if (::shutdown(socket_id, SHUT_RDWR) == SOCKET_ERROR)
+#else
+		if (::shutdown(socket_id, SD_BOTH) == SOCKET_ERROR)
+#endif
+			return get_last_error();
+	}
+
+	return 0;
+}
+
 int socket_t::close()
 {
 	if (socket_id != (SOCKET)0)
@@ -333,7 +766,7 @@ socket_t::~socket_t()
 	close();
 }
 
-int tcp_server_t::create(const std::string & ip, const uint16_t port)
+int tcp_server_t::create(const std::string & ip, const uint16_t port, const socket_options_t & options)
 {
 	//Create a socket
 	if ((server_id = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP)) == INVALID_SOCKET)
@@ -343,6 +776,22 @@ int tcp_server_t::create(const std::string & ip, const uint16_t port)
 		return error_code;
 	}
 
+	//Apply options
+	int ret = apply_options(server_id, true, options);
+
+#ifndef _WIN32
+	//Rebind while connections of a previous run on the port are in TIME_WAIT (winsock SO_REUSEADDR would allow port stealing)
+	if (ret == 0)
+		ret = set_int_option(server_id, SOL_SOCKET, SO_REUSEADDR, 1);
+#endif
+
+	if (ret != 0)
+	{
+		close();
+
+		return ret;
+	}
+
 	//Prepare the sockaddr_in structure
 	sockaddr_in address;
 	address.sin_family = AF_INET;
@@ -361,7 +810,7 @@ int tcp_server_t::create(const std::string & ip, const uint16_t port)
 	return 0;
 }
 
-int tcp_server_t::listen(socket_t & client_socket, const int backlog)
+int tcp_server_t::listen(const int backlog)
 {
 	//Listen
 	if (::listen(server_id, backlog) == SOCKET_ERROR)
@@ -372,15 +821,20 @@ int tcp_server_t::listen(socket_t & client_socket, const int backlog)
 		return error_code;
 	}
 
+	return 0;
+}
+
+int tcp_server_t::accept(socket_t & client_socket)
+{
 	//Accept
 	sockaddr_in address;
 	ADDRESS_LEN_T address_len = sizeof(address);
-	if ((client_socket.socket_id = accept(server_id, (sockaddr*)&address, &address_len)) == INVALID_SOCKET)
+	if ((client_socket.socket_id = ::accept(server_id, (sockaddr*)&address, &address_len)) == INVALID_SOCKET)
 	{
-		int error_code = get_last_error();
-		close();
+		// the server keeps listening, other acceptors may still be using it
+		client_socket.socket_id = (SOCKET)0;
 
-		return error_code;
+		return get_last_error();
 	}
 
 	return 0;
@@ -404,6 +858,21 @@ uint16_t tcp_server_t::port() const
 	return htons(address.sin_port);
 }
 
+int tcp_server_t::shutdown()
+{
+	if (server_id != (SOCKET)0)
+	{
+#ifdef __linux__
+		if (::shutdown(server_id, SHUT_RDWR) == SOCKET_ERROR)
+#else
+		if (::shutdown(server_id, SD_BOTH) == SOCKET_ERROR)
+#endif
+			return get_last_error();
+	}
+
+	return 0;
+}
+
 int tcp_server_t::close()
 {
 	if (server_id != (SOCKET)0)
@@ -542,3 +1011,57 @@ std::vector<adapter_info_t> ip_helper::get_adapters_info()
 	return adapters_list;
 }
 
+#ifdef __linux__
+
+int ip_helper::tcp_time_wait_count(uint64_t & count)
+{
+	// "TCP: inuse 5 orphan 0 tw 12 alloc 8 mem 1"
+	FILE * file = fopen("/proc/net/sockstat", "r");
+	if (file == nullptr)
+		return errno;
+
+	char line[256];
+	unsigned long long time_wait;
+	int ret{ ENOENT };
+
+	while (fgets(line, sizeof(line), file) != nullptr)
+	{
+		const char * field = strstr(line, " tw ");
+		if ((strncmp(line, "TCP:", 4) == 0) && (field != nullptr) && (sscanf(field, " tw %llu", &time_wait) == 1))
+		{
+			count = time_wait;
+			ret = 0;
+			break;
+		}
+	}
+
+	fclose(file);
+
+	return ret;
+}
+
+int ip_helper::local_port_range(int & first, int & last)
+{
+	FILE * file = fopen("/proc/sys/net/ipv4/ip_local_port_range", "r");
+	if (file == nullptr)
+		return errno;
+
+	const int ret{ fscanf(file, "%d %d", &first, &last) == 2 ? 0 : EINVAL };
+	fclose(file);
+
+	return ret;
+}
+
+#else
+
+int ip_helper::tcp_time_wait_count(uint64_t & count)
+{
+	return ERROR_NOT_SUPPORTED;
+}
+
+int ip_helper::local_port_range(int & first, int & last)
+{
+	return ERROR_NOT_SUPPORTED;
+}
+
+#endif
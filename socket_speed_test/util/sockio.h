@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 #include <stdint.h>
 
 #ifdef __linux__
@@ -32,10 +33,25 @@ struct adapter_info_t
 	std::string ip_mask;
 };
 
+// zero/empty fields keep the kernel default; tcp_* fields are ignored on udp sockets
+struct socket_options_t
+{
+	int send_buffer{ 0 };
+	int recv_buffer{ 0 };
+	bool tcp_no_delay{ false };
+	bool tcp_cork{ false };
+	int busy_poll_us{ 0 };
+	int tcp_notsent_lowat{ 0 };
+	bool reuse_port{ false };
+	std::string tcp_congestion;
+};
+
 class socket_t
 {
 public:
-	int create(const ip_protocol_t protocol, const std::string & ip = "", const uint16_t port = 0);
+	// options are applied before bind, so buffer sizes are in place for the tcp window scale negotiation
+	int create(const ip_protocol_t protocol, const std::string & ip = "", const uint16_t port = 0,
+		const socket_options_t & options = socket_options_t());
 	int connect(const std::string & pair_ip, const uint16_t pair_port);
 
 	int send(const char * packet, const int size);
@@ -46,29 +62,79 @@ public:
 	int recv_from(char * packet, const int size, std::string & pair_ip, uint16_t & pair_port);
 	int recv_any_from(char * packet, const int capacity, int & recvd_size, std::string & pair_ip, uint16_t & pair_port);
 
+	// datagram batches, one packet per buffer (sendmmsg/recvmmsg on linux, a send/recv loop elsewhere)
+	int send_batch(char * const * packets, const int size, const int count);
+	int recv_batch(char * const * packets, const int capacity, const int count, int * recvd_sizes, int & recvd_count);
+
+	// non-blocking receive; returns 0 with recvd_size = 0 if no data is pending
+	int try_recv(char * packet, const int capacity, int & recvd_size);
+	int set_blocking(const bool blocking);
+	int set_recv_timeout(const int timeout_ms); // blocking receives give up after timeout_ms (0: never)
+	// kernel pacing of everything sent on this socket (SO_MAX_PACING_RATE, linux 3.13+): tcp paces on its own
+	// since 4.13, udp needs the fq qdisc on the egress interface or the cap is silently ignored
+	int set_max_pacing_rate(const uint64_t bytes_per_s);
+
+	int set_options(const socket_options_t & options);
+	// values in effect after kernel clamping (linux reports twice the requested buffer sizes)
+	int get_options(socket_options_t & options) const;
+
+	// MSG_ZEROCOPY transmit (linux 4.14+): every successful send_zerocopy call takes the next notification id and
+	// the kernel keeps referencing the buffer until reap_zerocopy reported that id; ENOBUFS is returned without closing
+	static bool is_zerocopy_supported();
+	int set_zerocopy(const bool enabled);
+	int send_zerocopy(const char * packet, const int size, int & sent_size, uint32_t & notification_id);
+	// one completed id range from the error queue, waiting up to timeout_ms for it (reaped = false on timeout)
+	int reap_zerocopy(uint32_t & first_id, uint32_t & last_id, bool & copied, bool & reaped, const int timeout_ms);
+
 	std::string mine_ip() const;
 	uint16_t mine_port() const;
 
 	std::string pair_ip() const;
 	uint16_t pair_port() const;
 
+	// number of send/recv family syscalls issued on this socket so far
+	inline uint64_t syscall_count() const
+	{
+		return send_syscalls.load(std::memory_order_relaxed) + recv_syscalls.load(std::memory_order_relaxed);
+	}
+
+	// wakes up receives blocked on this socket from another thread (closing alone does not on linux)
+	int shutdown();
 	int close();
 	~socket_t();
 
 private:
+	// single writer per direction (a full duplex link sends and receives on two threads), so a relaxed load/store pair is enough
+	inline void count_syscall(const bool sending)
+	{
+		std::atomic<uint64_t> & syscalls{ sending ? send_syscalls : recv_syscalls };
+		syscalls.store(syscalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
 	SOCKET socket_id{ (SOCKET)0 };
+	std::atomic<uint64_t> send_syscalls{ 0 };
+	std::atomic<uint64_t> recv_syscalls{ 0 };
+	uint32_t zerocopy_id{ 0 };
 	friend class tcp_server_t;
+	friend class poller_t;
+	friend class uring_t;
 };
 
 class tcp_server_t
 {
 public:
-	int create(const std::string & ip = "", const uint16_t port = 0);
-	int listen(socket_t & client_socket, const int backlog = 1);
+	// accepted sockets inherit the options of the listening one
+	int create(const std::string & ip = "", const uint16_t port = 0, const socket_options_t & options = socket_options_t());
+	// listen once, then accept any number of clients (from one or more threads);
+	// listening before the first accept lets peers connect to every server in any order
+	int listen(const int backlog);
+	int accept(socket_t & client_socket);
 
 	std::string ip() const;
 	uint16_t port() const;
 
+	// wakes an accept blocked on this server from another thread
+	int shutdown();
 	int close();
 	~tcp_server_t();
 
@@ -82,6 +148,10 @@ public:
 	ip_helper() = delete;
 
 	static std::vector<adapter_info_t> get_adapters_info();
+
+	// host wide tcp sockets in TIME_WAIT and the ephemeral port range they hold ports of (linux only)
+	static int tcp_time_wait_count(uint64_t & count);
+	static int local_port_range(int & first, int & last);
 };
 
 #endif // !_SOCKIO_H_
@@ -0,0 +1,371 @@
+#include <cassert>
+#include <string.h>
+#include <errno.h>
+
+#include "uring.h"
+
+#ifdef __linux__
+
+#	include <linux/io_uring.h>
+#	include <sys/syscall.h>
+#	include <sys/socket.h>
+#	include <sys/uio.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+
+#	define load_acquire(ptr) __atomic_load_n((ptr), __ATOMIC_ACQUIRE)
+#	define store_release(ptr, val) __atomic_store_n((ptr), (val), __ATOMIC_RELEASE)
+
+static inline int io_uring_setup(unsigned entries, io_uring_params * params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static inline int io_uring_enter(int ring_id, unsigned to_submit, unsigned min_complete, unsigned flags, const void * arg = nullptr, std::size_t arg_size = 0)
+{
+	return (int)syscall(__NR_io_uring_enter, ring_id, to_submit, min_complete, flags, arg, arg_size);
+}
+
+static inline int io_uring_register(int ring_id, unsigned opcode, const void * arg, unsigned nr_args)
+{
+	return (int)syscall(__NR_io_uring_register, ring_id, opcode, arg, nr_args);
+}
+
+bool uring_t::is_supported()
+{
+	static const bool supported = []()
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		const int && ring_id = io_uring_setup(1, &params);
+		if (ring_id < 0)
+			return false;
+
+		::close(ring_id);
+
+		return (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+	}();
+
+	return supported;
+}
+
+int uring_t::create(socket_t & _link, const unsigned depth, char * _buffers, const unsigned buffer_count, const unsigned _buffer_len)
+{
+	assert(depth > 0);
+
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	if ((ring_id = io_uring_setup(depth, &params)) < 0)
+	{
+		int error_code = errno;
+		ring_id = 0;
+
+		return error_code;
+	}
+
+	if ((params.features & IORING_FEAT_SINGLE_MMAP) == 0)
+	{
+		close();
+
+		return ENOSYS;
+	}
+
+	sq_ring_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_ring_len = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	sq_ring_len = cq_ring_len = (sq_ring_len > cq_ring_len ? sq_ring_len : cq_ring_len);
+	sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+
+	sq_ring = mmap(nullptr, sq_ring_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_id, IORING_OFF_SQ_RING);
+	if (sq_ring == MAP_FAILED)
+	{
+		int error_code = errno;
+		sq_ring = nullptr;
+		close();
+
+		return error_code;
+	}
+
+	cq_ring = sq_ring;
+
+	sqes = (io_uring_sqe*)mmap(nullptr, sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_id, IORING_OFF_SQES);
+	if (sqes == MAP_FAILED)
+	{
+		int error_code = errno;
+		sqes = nullptr;
+		close();
+
+		return error_code;
+	}
+
+	sq_head = (unsigned*)((char*)sq_ring + params.sq_off.head);
+	sq_tail = (unsigned*)((char*)sq_ring + params.sq_off.tail);
+	sq_array = (unsigned*)((char*)sq_ring + params.sq_off.array);
+	sq_mask = *(unsigned*)((char*)sq_ring + params.sq_off.ring_mask);
+	sq_entries = params.sq_entries;
+	sq_local_tail = *sq_tail;
+	sq_pending = 0;
+
+	cq_head = (unsigned*)((char*)cq_ring + params.cq_off.head);
+	cq_tail = (unsigned*)((char*)cq_ring + params.cq_off.tail);
+	cq_mask = *(unsigned*)((char*)cq_ring + params.cq_off.ring_mask);
+	cqes = (io_uring_cqe*)((char*)cq_ring + params.cq_off.cqes);
+
+	//Register the socket as fixed file 0
+	const int fd{ _link.socket_id };
+	if (io_uring_register(ring_id, IORING_REGISTER_FILES, &fd, 1) < 0)
+	{
+		int error_code = errno;
+		close();
+
+		return error_code;
+	}
+
+	//Register packet buffers (optional, may exceed RLIMIT_MEMLOCK)
+	iovec * iov = new iovec[buffer_count];
+	for (unsigned i = 0; i < buffer_count; ++i)
+	{
+		iov[i].iov_base = _buffers + (std::size_t)i * _buffer_len;
+		iov[i].iov_len = _buffer_len;
+	}
+
+	fixed_buffers = (io_uring_register(ring_id, IORING_REGISTER_BUFFERS, iov, buffer_count) == 0);
+	delete[] iov;
+
+	int type{ 0 };
+	socklen_t type_len = sizeof(type);
+	getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &type_len);
+
+	link = &_link;
+	buffers = _buffers;
+	buffer_len = _buffer_len;
+	is_stream = (type == SOCK_STREAM);
+#ifdef IORING_FEAT_EXT_ARG
+	ext_arg = (params.features & IORING_FEAT_EXT_ARG) != 0;
+#else
+	ext_arg = false; // headers before 5.11, waits have no timeout
+#endif
+
+	return 0;
+}
+
+io_uring_sqe * uring_t::get_sqe()
+{
+	if (sq_local_tail - load_acquire(sq_head) >= sq_entries)
+		return nullptr;
+
+	const unsigned index{ sq_local_tail & sq_mask };
+	io_uring_sqe * sqe{ &sqes[index] };
+
+	sq_array[index] = index;
+	++sq_local_tail;
+	++sq_pending;
+
+	memset(sqe, 0, sizeof(*sqe));
+
+	return sqe;
+}
+
+int uring_t::prep_io(const bool is_send, const unsigned buffer_id, const int size, const uint64_t key, const bool linked)
+{
+	assert((unsigned)size <= buffer_len);
+
+	io_uring_sqe * sqe = get_sqe();
+	if (sqe == nullptr)
+		return EBUSY;
+
+	sqe->fd = 0; // fixed file index
+	sqe->flags = IOSQE_FIXED_FILE | (linked ? IOSQE_IO_LINK : 0);
+	sqe->addr = (uint64_t)(uintptr_t)(buffers + (std::size_t)buffer_id * buffer_len);
+	sqe->len = (unsigned)size;
+	sqe->user_data = key;
+
+	if (fixed_buffers && !is_stream)
+	{
+		// datagram read/write is atomic, so registered buffers can be used directly
+		sqe->opcode = is_send ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+		sqe->buf_index = (uint16_t)buffer_id;
+	}
+	else
+	{
+		// stream sockets need MSG_WAITALL so the kernel completes short transfers itself, sends to a closed peer fail without SIGPIPE
+		sqe->opcode = is_send ? IORING_OP_SEND : IORING_OP_RECV;
+		sqe->msg_flags = (is_stream ? MSG_WAITALL : 0) | (is_send ? MSG_NOSIGNAL : 0);
+	}
+
+	return 0;
+}
+
+int uring_t::prep_send(const unsigned buffer_id, const int size, const uint64_t key, const bool linked)
+{
+	return prep_io(true, buffer_id, size, key, linked);
+}
+
+int uring_t::prep_recv(const unsigned buffer_id, const int size, const uint64_t key, const bool linked)
+{
+	return prep_io(false, buffer_id, size, key, linked);
+}
+
+int uring_t::prep_cancel(const uint64_t target, const uint64_t key)
+{
+	io_uring_sqe * sqe = get_sqe();
+	if (sqe == nullptr)
+		return EBUSY;
+
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = target;
+	sqe->user_data = key;
+
+	return 0;
+}
+
+int uring_t::prep_cancel_all(const uint64_t key)
+{
+#ifdef IORING_ASYNC_CANCEL_ANY
+	io_uring_sqe * sqe = get_sqe();
+	if (sqe == nullptr)
+		return EBUSY;
+
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+	sqe->user_data = key;
+
+	return 0;
+#else
+	(void)key;
+
+	return ENOTSUP;
+#endif
+}
+
+int uring_t::submit(const unsigned wait_count, const int timeout_ms)
+{
+	store_release(sq_tail, sq_local_tail);
+
+	const unsigned to_submit{ sq_pending };
+	sq_pending = 0;
+
+	const unsigned flags{ wait_count > 0 ? (unsigned)IORING_ENTER_GETEVENTS : 0u };
+	int ret;
+
+#ifdef IORING_FEAT_EXT_ARG
+	if ((wait_count > 0) && (timeout_ms >= 0) && ext_arg)
+	{
+		__kernel_timespec timeout;
+		timeout.tv_sec = timeout_ms / 1000;
+		timeout.tv_nsec = (timeout_ms % 1000) * 1000000ll;
+
+		io_uring_getevents_arg arg;
+		memset(&arg, 0, sizeof(arg));
+		arg.ts = (uint64_t)(uintptr_t)&timeout;
+
+		ret = io_uring_enter(ring_id, to_submit, wait_count, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+	}
+	else
+#else
+	(void)timeout_ms;
+#endif
+		ret = io_uring_enter(ring_id, to_submit, wait_count, flags);
+
+	link->count_syscall(true); // a ring is driven by a single thread
+
+	if (ret < 0)
+		return (errno == EINTR || errno == ETIME) ? 0 : errno;
+
+	return 0;
+}
+
+bool uring_t::reap(uring_completion_t & completion)
+{
+	const unsigned head{ *cq_head };
+	if (head == load_acquire(cq_tail))
+		return false;
+
+	const io_uring_cqe & cqe{ cqes[head & cq_mask] };
+	completion.key = cqe.user_data;
+	completion.result = cqe.res;
+
+	store_release(cq_head, head + 1);
+
+	return true;
+}
+
+int uring_t::close()
+{
+	if (sqes != nullptr)
+	{
+		munmap(sqes, sqes_len);
+		sqes = nullptr;
+	}
+
+	if (sq_ring != nullptr)
+	{
+		munmap(sq_ring, sq_ring_len);
+		sq_ring = cq_ring = nullptr;
+	}
+
+	if (ring_id != 0)
+	{
+		::close(ring_id);
+		ring_id = 0;
+	}
+
+	return 0;
+}
+
+#else
+
+bool uring_t::is_supported()
+{
+	return false;
+}
+
+int uring_t::create(socket_t &, const unsigned, char *, const unsigned, const unsigned)
+{
+	return -1;
+}
+
+int uring_t::prep_send(const unsigned, const int, const uint64_t, const bool)
+{
+	return -1;
+}
+
+int uring_t::prep_recv(const unsigned, const int, const uint64_t, const bool)
+{
+	return -1;
+}
+
+int uring_t::prep_cancel(const uint64_t, const uint64_t)
+{
+	return -1;
+}
+
+int uring_t::prep_cancel_all(const uint64_t)
+{
+	return -1;
+}
+
+int uring_t::submit(const unsigned, const int)
+{
+	return -1;
+}
+
+bool uring_t::reap(uring_completion_t &)
+{
+	return false;
+}
+
+int uring_t::close()
+{
+	return 0;
+}
+
+#endif // __linux__
+
+uring_t::~uring_t()
+{
+	close();
+}
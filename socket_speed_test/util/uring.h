@@ -0,0 +1,78 @@
+#ifndef _URING_H_
+#define _URING_H_
+
+#include <stdint.h>
+
+#include "sockio.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+struct uring_completion_t
+{
+	uint64_t key;
+	int result; // transferred bytes or -error_code
+};
+
+// io_uring submission/completion queue bound to a single socket_t link (fixed file + registered buffers)
+class uring_t
+{
+public:
+	static bool is_supported();
+
+	// registers link as fixed file and buffer_count buffers of buffer_len bytes (contiguous at buffers)
+	int create(socket_t & link, const unsigned depth, char * buffers, const unsigned buffer_count, const unsigned buffer_len);
+
+	// queue one send/recv of size bytes on buffer_id; linked entries run in order (tcp)
+	int prep_send(const unsigned buffer_id, const int size, const uint64_t key, const bool linked = false);
+	int prep_recv(const unsigned buffer_id, const int size, const uint64_t key, const bool linked = false);
+
+	// requests cancellation of the in-flight entry queued with target, or of every in-flight entry (ENOTSUP without
+	// IORING_ASYNC_CANCEL_ANY in the headers, -EINVAL from kernels before 5.19); the cancel entry completes with key
+	// and the cancelled ones still have to be reaped
+	int prep_cancel(const uint64_t target, const uint64_t key);
+	int prep_cancel_all(const uint64_t key);
+
+	// submits queued entries and waits for at least wait_count completions (up to timeout_ms if non-negative)
+	int submit(const unsigned wait_count, const int timeout_ms = -1);
+	bool reap(uring_completion_t & completion);
+
+	inline unsigned pending() const { return sq_pending; }
+
+	int close();
+	~uring_t();
+
+private:
+	io_uring_sqe * get_sqe();
+	int prep_io(const bool is_send, const unsigned buffer_id, const int size, const uint64_t key, const bool linked);
+
+	int ring_id{ 0 };
+	socket_t * link{ nullptr };
+	char * buffers{ nullptr };
+	unsigned buffer_len{ 0 };
+	bool fixed_buffers{ false };
+	bool is_stream{ false };
+	bool ext_arg{ false };
+
+	void * sq_ring{ nullptr };
+	void * cq_ring{ nullptr };
+	io_uring_sqe * sqes{ nullptr };
+	std::size_t sq_ring_len{ 0 };
+	std::size_t cq_ring_len{ 0 };
+	std::size_t sqes_len{ 0 };
+
+	unsigned * sq_head{ nullptr };
+	unsigned * sq_tail{ nullptr };
+	unsigned * sq_array{ nullptr };
+	unsigned sq_mask{ 0 };
+	unsigned sq_entries{ 0 };
+	unsigned sq_local_tail{ 0 };
+	unsigned sq_pending{ 0 };
+
+	unsigned * cq_head{ nullptr };
+	unsigned * cq_tail{ nullptr };
+	unsigned cq_mask{ 0 };
+	io_uring_cqe * cqes{ nullptr };
+};
+
+#endif // !_URING_H_
@@ -0,0 +1,167 @@
+#include <cassert>
+#include <errno.h>
+#include <string.h>
+
+#include "zerocopy_ring.h"
+
+#define ZEROCOPY_PAGE_SIZE 4096
+#define ZEROCOPY_WAIT_MS 100
+
+int zerocopy_ring_t::create(socket_t & _link, const unsigned _buffer_count, const unsigned _buffer_len)
+{
+	assert(_buffer_count > 0);
+
+	if (!socket_t::is_zerocopy_supported())
+		return -1;
+
+	int ret = _link.set_zerocopy(true);
+	if (ret != 0)
+		return ret;
+
+	link = &_link;
+	buffer_count = _buffer_count;
+	buffer_len = (_buffer_len + ZEROCOPY_PAGE_SIZE - 1) & ~(unsigned)(ZEROCOPY_PAGE_SIZE - 1);
+
+	// page aligned, so a buffer never shares a pinned page with its neighbour
+	memory = new char[(std::size_t)buffer_count * buffer_len + ZEROCOPY_PAGE_SIZE];
+	buffers = (char*)(((uintptr_t)memory + ZEROCOPY_PAGE_SIZE - 1) & ~(uintptr_t)(ZEROCOPY_PAGE_SIZE - 1));
+	slots = new slot_t[buffer_count];
+
+	memset(buffers, 0, (std::size_t)buffer_count * buffer_len);
+
+	next = 0;
+	in_flight = 0;
+
+	return 0;
+}
+
+int zerocopy_ring_t::acquire(char *& buffer, const int timeout_ms)
+{
+	buffer = nullptr;
+
+	if (slots[next].pending > 0)
+	{
+		int ret = reap(timeout_ms);
+		if ((ret != 0) || (slots[next].pending > 0))
+			return ret;
+	}
+
+	buffer = buffers + (std::size_t)next * buffer_len;
+
+	return 0;
+}
+
+int zerocopy_ring_t::send(const int size)
+{
+	slot_t & slot{ slots[next] };
+	const char * buffer{ buffers + (std::size_t)next * buffer_len };
+	int offset{ 0 };
+
+	slot.sends = 0;
+	while (offset < size)
+	{
+		int sent_size{ 0 };
+		uint32_t notification_id{ 0 };
+
+		int ret = link->send_zerocopy(buffer + offset, size - offset, sent_size, notification_id);
+		if (ret == ENOBUFS)
+		{
+			ret = reap(ZEROCOPY_WAIT_MS);
+			if (ret != 0)
+				return ret;
+
+			continue;
+		}
+
+		if (ret != 0)
+			return ret;
+
+		if (slot.sends++ == 0)
+			slot.first_id = notification_id;
+
+		if (slot.pending++ == 0)
+			++in_flight;
+		offset += sent_size;
+	}
+
+	next = (next + 1) % buffer_count;
+
+	// keep the error queue short, completions are cheap to take while they are already there
+	return reap(0);
+}
+
+int zerocopy_ring_t::drain(const int timeout_ms)
+{
+	int waited_ms{ 0 };
+
+	while ((in_flight > 0) && (waited_ms < timeout_ms))
+	{
+		int ret = reap(ZEROCOPY_WAIT_MS);
+		if (ret != 0)
+			return ret;
+
+		waited_ms += ZEROCOPY_WAIT_MS;
+	}
+
+	return in_flight == 0 ? 0 : ETIMEDOUT;
+}
+
+int zerocopy_ring_t::reap(const int timeout_ms)
+{
+	int wait_ms{ timeout_ms };
+
+	do
+	{
+		uint32_t first_id, last_id;
+		bool was_copied, reaped;
+
+		int ret = link->reap_zerocopy(first_id, last_id, was_copied, reaped, wait_ms);
+		if ((ret != 0) || !reaped)
+			return ret;
+
+		// ranges may complete out of order, so match every id against the buffers in flight
+		const uint32_t range_len{ last_id - first_id };
+		for (unsigned slot_id = 0; slot_id < buffer_count; ++slot_id)
+		{
+			slot_t & slot{ slots[slot_id] };
+			if (slot.pending == 0)
+				continue;
+
+			for (uint32_t send_id = 0; send_id < slot.sends; ++send_id)
+			{
+				if ((uint32_t)(slot.first_id + send_id - first_id) <= range_len)
+				{
+					--slot.pending;
+					++completed;
+					if (was_copied)
+						++copied;
+				}
+			}
+
+			if (slot.pending == 0)
+				--in_flight;
+		}
+
+		wait_ms = 0; // take whatever else is queued without blocking
+	} while (true);
+}
+
+int zerocopy_ring_t::close()
+{
+	delete[] slots;
+	delete[] memory;
+
+	slots = nullptr;
+	memory = nullptr;
+	buffers = nullptr;
+	link = nullptr;
+	buffer_count = 0;
+	in_flight = 0;
+
+	return 0;
+}
+
+zerocopy_ring_t::~zerocopy_ring_t()
+{
+	close();
+}
@@ -0,0 +1,57 @@
+#ifndef _ZEROCOPY_RING_H_
+#define _ZEROCOPY_RING_H_
+
+#include <stdint.h>
+
+#include "sockio.h"
+
+// transmit buffers for MSG_ZEROCOPY sends on one socket_t link; a buffer is handed out again only after
+// the kernel reported every send that referenced it as completed
+class zerocopy_ring_t
+{
+public:
+	zerocopy_ring_t() = default;
+	zerocopy_ring_t(const zerocopy_ring_t&) = delete;
+	zerocopy_ring_t& operator=(const zerocopy_ring_t&) = delete;
+
+	// enables SO_ZEROCOPY on link and allocates buffer_count page aligned buffers of buffer_len bytes
+	int create(socket_t & link, const unsigned buffer_count, const unsigned buffer_len);
+
+	// next buffer in ring order, waits up to timeout_ms for its completions (buffer = nullptr if still in flight)
+	int acquire(char *& buffer, const int timeout_ms);
+	// sends size bytes of the buffer returned by the last acquire
+	int send(const int size);
+
+	// waits up to timeout_ms for the completions of every buffer still in flight
+	int drain(const int timeout_ms);
+
+	inline uint64_t completed_count() const { return completed; }
+	inline uint64_t copied_count() const { return copied; } // completions the kernel served by copying (loopback, no sg nic)
+
+	int close();
+	~zerocopy_ring_t();
+
+private:
+	struct slot_t
+	{
+		uint32_t first_id{ 0 };
+		uint32_t pending{ 0 }; // notification ids of this buffer not completed yet
+		uint32_t sends{ 0 };
+	};
+
+	int reap(const int timeout_ms);
+
+	socket_t * link{ nullptr };
+	char * memory{ nullptr };
+	char * buffers{ nullptr };
+	slot_t * slots{ nullptr };
+	unsigned buffer_count{ 0 };
+	unsigned buffer_len{ 0 };
+	unsigned next{ 0 };
+	unsigned in_flight{ 0 };
+
+	uint64_t completed{ 0 };
+	uint64_t copied{ 0 };
+};
+
+#endif // !_ZEROCOPY_RING_H_